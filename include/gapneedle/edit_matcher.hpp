@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace gapneedle {
+
+// Finds where a pattern occurs with at most `maxEdits` substitutions, insertions and deletions,
+// using Myers' bit-vector algorithm: one text base advances a whole column of the edit-distance
+// matrix with a few word operations per 64 pattern bases (Hyyrö's block form for longer patterns).
+class EditMatcher {
+ public:
+  // `pattern` is case-insensitive; bases other than ACGT never match (in the pattern or the text).
+  // `maxEdits` must be smaller than the pattern length.
+  EditMatcher(const std::string& pattern, unsigned maxEdits);
+
+  std::size_t patternLength() const { return length_; }
+  unsigned maxEdits() const { return maxEdits_; }
+
+  // Reports ends e (exclusive offsets into `text`) in [from, to] where some substring of
+  // text[0, e) ending at e is within maxEdits of the pattern. Of consecutive ends that share an
+  // occurrence only the best is reported: e is reported when its distance is below that of e - 1
+  // and not above that of e + 1 (distances beyond maxEdits count as equal; the text is taken to
+  // end at n). Distances are exact once e >= maxEdits + pattern length. `text` must be uppercase.
+  using HitCallback = std::function<void(std::size_t end, unsigned edits)>;
+  void scan(const char* text, std::size_t n, std::size_t from, std::size_t to, const HitCallback& onHit) const;
+
+  // Start of an optimal alignment of the pattern ending at `end`, preferring the one whose length
+  // is closest to the pattern's. Reads text[max(0, end - length - maxEdits), end).
+  std::size_t alignStart(const char* text, std::size_t end) const;
+
+ private:
+  void scanWords(const char* text, std::size_t n, std::size_t from, std::size_t to, const HitCallback& onHit) const;
+
+  std::string pattern_;
+  std::size_t length_{0};
+  unsigned maxEdits_{0};
+  std::size_t words_{0};
+  std::vector<std::uint64_t> peq_;  // per base code (ACGT, other), `words_` match masks
+};
+
+}  // namespace gapneedle
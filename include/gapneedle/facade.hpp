@@ -1,7 +1,9 @@
 #pragma once
 
 #include "gapneedle/aligner.hpp"
+#include "gapneedle/gap_service.hpp"
 #include "gapneedle/guided_stitch_service.hpp"
+#include "gapneedle/search_service.hpp"
 #include "gapneedle/stitch_service.hpp"
 #include "gapneedle/types.hpp"
 
@@ -16,8 +18,18 @@ class GapNeedleFacade {
 
   AlignmentResult align(const AlignmentRequest& request) const;
   StitchResult stitch(const StitchRequest& request) const;
-  std::vector<std::tuple<std::string, int, int>> scanGaps(const std::string& fastaPath,
-                                                          int minGap = 10) const;
+  std::vector<std::tuple<std::string, SeqPos, SeqPos>> scanGaps(const std::string& fastaPath,
+                                                                SeqPos minGap = 10) const;
+  void scanGaps(const std::string& fastaPath, const GapScanOptions& options, const GapSink& sink) const;
+  // Answered from the persistent gap index (built and saved on first use); see GapIndex.
+  std::vector<GapRecord> queryGaps(const std::string& fastaPath, const GapQuery& query) const;
+  void search(const std::string& fastaPath,
+              const std::string& query,
+              const SearchOptions& options,
+              const SearchSink& sink) const;
+  std::size_t countSearchHits(const std::string& fastaPath,
+                              const std::string& query,
+                              const SearchOptions& options) const;
   GuidedSeedResult guidedSeed(const GuidedSeedRequest& request) const;
   GuidedStepResult guidedNext(const GuidedStepRequest& request) const;
 
@@ -1,6 +1,15 @@
 #pragma once
 
+#include "gapneedle/packed_sequence.hpp"
+#include "gapneedle/types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -9,9 +18,41 @@ namespace gapneedle {
 
 using FastaMap = std::unordered_map<std::string, std::string>;
 
+struct FastaReaderOptions {
+  // Map the FASTA into memory; when false (or when mapping fails) fetches use positioned reads
+  // (pread) on one persistent descriptor. Both backends are safe for concurrent fetches.
+  bool useMmap{true};
+  // Decompressed 64 KiB blocks kept per reader for BGZF-compressed (.fa.gz + .gzi) input.
+  std::size_t bgzfCacheBlocks{256};
+  // Decoded (uppercased, newline-free) blocks of `blockCacheBlockBases` bases kept per reader, up
+  // to `blockCacheBytes`, so repeated fetches around the same positions are served from memory.
+  // Fetches spanning more than a quarter of the budget bypass the cache. 0 disables it.
+  std::size_t blockCacheBytes{16u << 20};
+  std::size_t blockCacheBlockBases{64u << 10};
+};
+
+struct FastaBlockCacheStats {
+  std::uint64_t hits{0};
+  std::uint64_t misses{0};
+  std::size_t blocks{0};
+  std::size_t bytes{0};
+};
+
+// One slice for FastaIndexedReader::fetchMany. [start, end) is clamped like fetch(). With `reverse`
+// the coordinates address the reverse-complemented contig, i.e. the result is the reverse
+// complement of forward [len - end, len - start).
+struct FastaRegion {
+  std::string seqName;
+  SeqPos start{0};
+  SeqPos end{0};
+  bool reverse{false};
+};
+
+// Random access to plain FASTA (via .fai), bgzipped FASTA (via .fai + .gzi) and .gnseq
+// containers, chosen by sniffing the file.
 class FastaIndexedReader {
  public:
-  explicit FastaIndexedReader(std::string fastaPath);
+  explicit FastaIndexedReader(std::string fastaPath, FastaReaderOptions options = {});
   ~FastaIndexedReader();
   FastaIndexedReader(FastaIndexedReader&&) noexcept;
   FastaIndexedReader& operator=(FastaIndexedReader&&) noexcept;
@@ -20,8 +61,37 @@ class FastaIndexedReader {
 
   const std::string& fastaPath() const;
   std::vector<std::string> listNames() const;
-  int length(const std::string& seqName) const;
-  std::string fetch(const std::string& seqName, int start, int end) const;  // [start, end)
+  SeqPos length(const std::string& seqName) const;  // -1 when the sequence is unknown
+  std::string fetch(const std::string& seqName, SeqPos start, SeqPos end) const;  // [start, end)
+  // Copies uppercase bases of [start, end) into `out`, which must hold at least end - start chars.
+  // Returns the number of bases written after clamping to the sequence bounds.
+  std::size_t fetchInto(const std::string& seqName, SeqPos start, SeqPos end, char* out) const;
+  // Single-region fetch with the strand handling of FastaRegion.
+  std::string fetch(const FastaRegion& region) const;
+  // Fetches many slices at once, returned in request order. Requests are sorted by file offset and
+  // nearby byte ranges are coalesced, so breakpoint contexts of many segments cost a few large
+  // sequential reads instead of one read per slice.
+  std::vector<std::string> fetchMany(const std::vector<FastaRegion>& regions) const;
+  // Asynchronous fetches run on a small process-wide I/O worker set. A readahead hint for the
+  // region is issued before queuing, so submitting every upcoming read at once overlaps their disk
+  // time with whatever the caller does meanwhile. The reader must outlive its pending requests.
+  // Callbacks run on an I/O worker, receive either the bases or the error, and must not throw.
+  using FetchCallback = std::function<void(std::string seq, std::exception_ptr error)>;
+  void fetchAsync(FastaRegion region, FetchCallback done) const;
+  std::future<std::string> fetchAsync(FastaRegion region) const;
+  // Readahead hints only (madvise / posix_fadvise WILLNEED); never blocks on I/O. Unknown sequence
+  // names are ignored.
+  void prefetch(const std::vector<FastaRegion>& regions) const;
+  // 64-bit FNV-1a digest of the uppercase bases: stored in .gnseq containers, computed by a full
+  // pass for FASTA input. Equal digests identify identical sequences across both formats.
+  std::uint64_t sequenceDigest(const std::string& seqName) const;
+  // Block cache counters since construction (all zero when the cache is disabled).
+  FastaBlockCacheStats blockCacheStats() const;
+  // Zero-copy access: calls `chunk` with consecutive raw (case-preserved) line pieces of [start, end).
+  void visit(const std::string& seqName,
+             SeqPos start,
+             SeqPos end,
+             const std::function<void(std::string_view)>& chunk) const;
 
  private:
   struct Impl;
@@ -29,15 +99,98 @@ class FastaIndexedReader {
   std::unique_ptr<Impl> impl_;
 };
 
+// Sequential record-at-a-time FASTA parser with a reusable buffer (plain or BGZF input).
+// Bases come back uppercased with whitespace removed, matching readFasta.
+//
+//   FastaStreamReader in(path);
+//   std::string name, seq;
+//   while (in.next(name, seq)) { ... }            // whole records
+//
+//   while (in.nextRecord(name)) {                  // or bounded chunks of one record
+//     while (in.readChunk(seq, 1 << 20)) { ... }
+//   }
+class FastaStreamReader {
+ public:
+  explicit FastaStreamReader(const std::string& path, std::size_t bufferBytes = 1 << 20);
+  ~FastaStreamReader();
+  FastaStreamReader(FastaStreamReader&&) noexcept;
+  FastaStreamReader& operator=(FastaStreamReader&&) noexcept;
+  FastaStreamReader(const FastaStreamReader&) = delete;
+  FastaStreamReader& operator=(const FastaStreamReader&) = delete;
+
+  // Reads the next whole record into `name` and `seq`, reusing their storage.
+  bool next(std::string& name, std::string& seq);
+  // Advances to the next record header, skipping any unread bases of the current record.
+  bool nextRecord(std::string& name);
+  // Replaces `chunk` with up to `maxBases` further bases of the current record.
+  // Returns false once the record is exhausted.
+  bool readChunk(std::string& chunk, std::size_t maxBases);
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+struct FastaWriterOptions {
+  std::size_t lineWidth{80};
+  // Output is wrapped into this buffer and written in large blocks.
+  std::size_t bufferBytes{4u << 20};
+  // Also publish `<path>.fai`, computed while writing. Without it a stale index is removed.
+  bool writeFai{false};
+};
+
+// Incremental FASTA writer: records are written as a header followed by any number of base
+// pieces, wrapped at `lineWidth`. Output goes to a temporary beside `path` that commit() renames
+// into place; a writer destroyed without commit() leaves `path` untouched.
+//
+//   FastaWriter out(path);
+//   out.beginRecord("chr1");
+//   out.append(piece1);
+//   out.append(piece2);
+//   out.commit();
+class FastaWriter {
+ public:
+  explicit FastaWriter(std::string path, FastaWriterOptions options = {});
+  ~FastaWriter();
+  FastaWriter(FastaWriter&&) noexcept;
+  FastaWriter& operator=(FastaWriter&&) noexcept;
+  FastaWriter(const FastaWriter&) = delete;
+  FastaWriter& operator=(const FastaWriter&) = delete;
+
+  void beginRecord(const std::string& name);
+  void append(std::string_view bases);
+  void writeRecord(const std::string& name, std::string_view bases);
+  void commit();
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+// Process-wide bounded pool of readers keyed by path, size and mtime. A file that changed on disk
+// gets a fresh reader; least recently used readers are dropped once the pool is full.
+std::shared_ptr<const FastaIndexedReader> acquireFastaReader(const std::string& fastaPath);
+void setFastaReaderPoolCapacity(std::size_t capacity);
+void clearFastaReaderPool();
+
 FastaMap readFasta(const std::string& path);
+// Same records as readFasta, held 2-bit packed (about a quarter of the memory).
+PackedFastaMap readFastaPacked(const std::string& path);
 FastaMap readFastaSelected(const std::string& path, const std::vector<std::string>& names);
 std::vector<std::string> readFastaNames(const std::string& path);
 std::vector<std::string> readFastaNamesIndexed(const std::string& path);
 std::string readFastaSliceIndexed(const std::string& path,
                                   const std::string& seqName,
-                                  int start,
-                                  int end);  // [start, end)
+                                  SeqPos start,
+                                  SeqPos end);  // [start, end)
+// Records are written in name order, so the output is reproducible.
 void writeFasta(const std::string& path, const FastaMap& records);
+// Converts a FASTA (plain or bgzipped) into a `.gnseq` container: 2-bit packed bases, a table of
+// N/IUPAC runs and a digest per sequence, laid out for direct memory mapping so opening is a header
+// check. FastaIndexedReader, readFasta, readFastaPacked and readFastaNames accept the result;
+// bases come back uppercase.
+void writeGnseq(const std::string& fastaPath, const std::string& gnseqPath);
+bool isGnseqFile(const std::string& path);
 std::string reverseComplement(const std::string& seq);
 
 }  // namespace gapneedle
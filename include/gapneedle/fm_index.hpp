@@ -0,0 +1,69 @@
+#pragma once
+
+#include "gapneedle/search_service.hpp"
+#include "gapneedle/types.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gapneedle {
+
+// FM-index (BWT with rank blocks and a sampled suffix array) over every sequence of a FASTA,
+// for exact-match counts and locations without rescanning the genome. Sequences are joined with
+// a separator so matches never span two of them; bases other than ACGT never match.
+//
+// The index lives in one file (`fmIndexPathOf`) keyed by the FASTA's size and mtime and is
+// memory-mapped on open. A missing or stale file is rebuilt (suffix array by SA-IS) and written
+// atomically; if it cannot be written the index is kept in memory instead. Building takes the
+// text (1 byte per base), the suffix array and the ~1.25 bytes per base of output: about 6 bytes
+// per base with a 32-bit suffix array, and about 10 once the text reaches 2^32 bases (64-bit). A build throws once `cancel` reads true.
+class FmIndex {
+ public:
+  FmIndex(const std::string& fastaPath, const std::string& indexPath, const std::atomic<bool>* cancel = nullptr);
+  ~FmIndex();
+  FmIndex(const FmIndex&) = delete;
+  FmIndex& operator=(const FmIndex&) = delete;
+
+  bool loadedFromFile() const { return loadedFromFile_; }
+  // True when `query` is non-empty and only ACGT (any case), i.e. answerable by this index.
+  static bool supports(const std::string& query);
+  // Forward-strand occurrences of `query` (0 when unsupported).
+  SeqPos count(const std::string& query) const;
+  // Occurrences in file order, then by position (forward before reverse), like searchFasta.
+  std::vector<SearchHit> locate(const std::string& query, bool bothStrands) const;
+
+  // On-disk layout, defined in fm_index.cpp.
+  struct Header;
+  struct Block;
+  struct SequenceEntry;
+
+ private:
+  bool open(const std::string& indexPath, std::uint64_t fastaSize, std::int64_t fastaMtime);
+  bool attach(const char* data, std::size_t size, std::uint64_t fastaSize, std::int64_t fastaMtime);
+  // [sp, ep) rows of the suffixes prefixed by `pattern` (uppercase ACGT).
+  void range(const std::string& pattern, std::uint64_t& sp, std::uint64_t& ep) const;
+  std::uint64_t occ(int code, std::uint64_t row) const;
+  std::uint64_t textPosition(std::uint64_t row) const;
+
+  struct Storage;
+  std::unique_ptr<Storage> storage_;
+  const Header* header_{nullptr};
+  const SequenceEntry* sequences_{nullptr};
+  const char* names_{nullptr};
+  const Block* blocks_{nullptr};
+  const std::uint64_t* samples_{nullptr};
+  bool loadedFromFile_{false};
+};
+
+// `<cacheDir>/<hash>.gnfm`, the hash covering the FASTA path, size and mtime (like the .mmi cache).
+std::string fmIndexPathOf(const std::string& fastaPath, const std::string& cacheDir);
+// Process-wide pool like acquireGapIndex: a FASTA that changed on disk gets a fresh index.
+std::shared_ptr<const FmIndex> acquireFmIndex(const std::string& fastaPath,
+                                              const std::string& cacheDir,
+                                              const std::atomic<bool>* cancel = nullptr);
+void clearFmIndexPool();
+
+}  // namespace gapneedle
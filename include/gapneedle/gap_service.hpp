@@ -0,0 +1,89 @@
+#pragma once
+
+#include "gapneedle/types.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gapneedle {
+
+struct GapRecord {
+  std::string seqName;
+  SeqPos start{0};
+  SeqPos end{0};  // exclusive
+};
+
+struct GapScanOptions {
+  SeqPos minGap{10};
+  // Also count soft-masked 'n'. .gnseq input keeps bases uppercase, so there it is always on.
+  bool caseInsensitive{true};
+  unsigned threads{0};  // 0 = hardware concurrency
+};
+
+// Receives the gaps of one sequence (possibly none). Calls are serialised and arrive in file
+// order, each as soon as that sequence and all sequences before it have been scanned.
+using GapSink = std::function<void(const std::string& seqName, const std::vector<GapRecord>& gaps)>;
+
+// Scans sequences in parallel (one task per sequence) with positioned reads located through the
+// .fai, so the genome is never loaded: each worker holds one window of a few MB. .gnseq input is
+// answered from its stored N-run table.
+void scanGaps(const std::string& fastaPath, const GapScanOptions& options, const GapSink& sink);
+std::vector<GapRecord> scanGaps(const std::string& fastaPath, const GapScanOptions& options = {});
+
+struct GapQuery {
+  std::string seqName;  // empty: every sequence
+  SeqPos start{0};      // range [start, end) of `seqName`; gaps overlapping it are returned whole
+  SeqPos end{-1};       // -1: to the sequence end
+  SeqPos minGap{10};
+  bool caseInsensitive{true};
+};
+
+// Every N run of a FASTA, persisted in a sidecar (`<fasta>.gapidx`, or `<fasta>.cs.gapidx` for
+// case-sensitive scans) keyed by the FASTA's size and mtime. A matching sidecar is loaded without
+// reading any sequence bytes; otherwise the FASTA is scanned once and the sidecar rewritten
+// atomically. A sidecar that cannot be written is not an error: the index then lives in memory.
+// Queries binary-search runs kept both in position order and in length order.
+class GapIndex {
+ public:
+  explicit GapIndex(const std::string& fastaPath, bool caseInsensitive = true);
+
+  bool loadedFromSidecar() const { return loadedFromSidecar_; }
+  std::vector<std::string> names() const;
+  // Results come in file order, then by position. Unknown sequence names give no gaps.
+  std::vector<GapRecord> query(const GapQuery& query) const;
+
+ private:
+  struct Run {
+    SeqPos start;
+    SeqPos end;
+  };
+  struct Sequence {
+    std::string name;
+    std::vector<Run> runs;                // by start; runs never overlap, so also by end
+    std::vector<std::uint32_t> byLength;  // indices into `runs`, longest first
+  };
+
+  bool load(const std::string& sidecarPath, std::uint64_t fastaSize, std::int64_t fastaMtime, bool caseInsensitive);
+  void save(const std::string& sidecarPath, std::uint64_t fastaSize, std::int64_t fastaMtime, bool caseInsensitive) const;
+  void addSequence(Sequence seq);
+  void collect(const Sequence& seq, const GapQuery& query, std::vector<GapRecord>& out) const;
+
+  std::vector<Sequence> sequences_;
+  std::unordered_map<std::string, std::size_t> byName_;
+  bool loadedFromSidecar_{false};
+};
+
+std::string gapIndexPathOf(const std::string& fastaPath, bool caseInsensitive = true);
+// Process-wide pool like acquireFastaReader: a FASTA that changed on disk gets a fresh index.
+std::shared_ptr<const GapIndex> acquireGapIndex(const std::string& fastaPath, bool caseInsensitive = true);
+void clearGapIndexPool();
+
+// BED3 lines: name, start, end (0-based, half-open).
+void writeGapsBed(std::ostream& out, const std::vector<GapRecord>& gaps);
+
+}  // namespace gapneedle
@@ -4,6 +4,6 @@
 
 namespace gapneedle {
 
-MappingResult mapQueryToTargetDetail(const AlignmentRecord& rec, int qPos);
+MappingResult mapQueryToTargetDetail(const AlignmentRecord& rec, SeqPos qPos);
 
 }  // namespace gapneedle
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "gapneedle/types.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gapneedle {
+
+struct MotifRunStats {
+  SeqPos copies{0};      // non-overlapping copies (either strand)
+  SeqPos longestRun{0};  // most copies in a row, each starting where the previous one ended
+};
+
+// Counts tandem copies of several motifs in one pass over the sequence. All motifs, and their
+// reverse complements, are compiled into one Aho-Corasick automaton over ACGT, so the cost per
+// base is a single table lookup however many motifs are searched. Each strand of each motif is
+// counted like a greedy left-to-right scan that skips a whole motif after every copy.
+class MotifScanner {
+ public:
+  // Motifs are case-insensitive and must be non-empty. Bases other than ACGT never match, as in
+  // the text, so a motif containing one is kept but never counted. Repeated motifs (and, with
+  // `bothStrands`, motifs that are the reverse complement of an earlier one) are merged.
+  explicit MotifScanner(const std::vector<std::string>& motifs, bool bothStrands = true);
+
+  // Uppercased motifs in the order given (duplicates removed); stats are reported in this order.
+  const std::vector<std::string>& motifs() const { return motifs_; }
+
+  // Returns one entry per motif. `onCopy`, when set, receives every counted copy as [start, end),
+  // by ascending end and, for copies ending at the same base, longest first.
+  using CopyCallback = std::function<void(SeqPos start, SeqPos end)>;
+  std::vector<MotifRunStats> scan(std::string_view seq, const CopyCallback& onCopy = {}) const;
+
+ private:
+  struct Pattern {
+    std::uint32_t motif;  // index into motifs_
+    std::uint32_t length;
+  };
+
+  std::vector<std::string> motifs_;
+  std::vector<Pattern> patterns_;            // one per distinct strand sequence
+  std::vector<std::int32_t> next_;           // DFA: 4 transitions per state
+  std::vector<std::uint32_t> outputBegin_;   // per state, range into outputs_ (size states + 1)
+  std::vector<std::uint32_t> outputs_;       // pattern ids ending at each state, longest first
+};
+
+}  // namespace gapneedle
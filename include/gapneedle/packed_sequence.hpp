@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace gapneedle {
+
+// Run of identical non-ACGT bases (N gaps, IUPAC codes) kept beside the 2-bit payload.
+struct AmbiguityRun {
+  std::uint64_t start{0};
+  std::uint64_t length{0};
+  char base{'N'};
+};
+
+// Uppercase nucleotide sequence stored at 2 bits per base. Anything outside ACGT is recorded
+// in a sorted run list and restored on decode, so round trips are lossless apart from case.
+class PackedSequence {
+ public:
+  PackedSequence() = default;
+  explicit PackedSequence(std::string_view seq);
+
+  // Appends bases; whitespace is skipped and letters are uppercased.
+  void append(std::string_view bases);
+  void shrinkToFit();
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  char at(std::size_t pos) const;
+  std::string decode(std::size_t start, std::size_t end) const;  // [start, end), clamped
+  std::string decode() const { return decode(0, size_); }
+  // Writes [start, end) into `out` (must hold end - start chars); returns bases written.
+  std::size_t decodeInto(std::size_t start, std::size_t end, char* out) const;
+
+  const std::vector<AmbiguityRun>& ambiguityRuns() const { return runs_; }
+  // Raw 2-bit payload: 4 bases per byte, first base in the low bits, A=0 C=1 G=2 T=3.
+  const std::vector<std::uint8_t>& packedBytes() const { return packed_; }
+  std::size_t memoryBytes() const;
+
+ private:
+  void pushBase(char upper);
+
+  std::vector<std::uint8_t> packed_;  // 4 bases per byte, first base in the low bits
+  std::vector<AmbiguityRun> runs_;
+  std::size_t size_{0};
+};
+
+using PackedFastaMap = std::unordered_map<std::string, PackedSequence>;
+
+}  // namespace gapneedle
@@ -7,6 +7,8 @@
 
 namespace gapneedle {
 
+// Records whose query and target names match exactly. The file is memory-mapped and split in
+// place; lines with fewer than 12 columns are skipped, malformed numbers in a matching record throw.
 std::vector<AlignmentRecord> parsePaf(const std::string& path,
                                       const std::string& targetSeq,
                                       const std::string& querySeq);
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "gapneedle/types.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace gapneedle {
+
+struct SearchHit {
+  std::string seqName;
+  SeqPos start{0};  // forward-strand coordinates, [start, end)
+  SeqPos end{0};
+  bool reverse{false};  // the reverse complement of the query matched here
+  unsigned edits{0};    // edit distance between the query (strand) and [start, end)
+};
+
+struct SearchOptions {
+  // Also report matches of the query's reverse complement (found in the same pass). A query that
+  // is its own reverse complement is reported on the forward strand only.
+  bool bothStrands{true};
+  unsigned threads{0};         // 0 = hardware concurrency
+  std::size_t batchHits{4096};  // most hits per sink call
+  std::size_t maxHits{0};       // stop after this many hits; 0 = no limit
+  // Allow up to this many substitutions, insertions and deletions (must be below the query
+  // length); 0 = exact matching.
+  unsigned maxEdits{0};
+  // Answer exact ACGT-only queries from the FM-index cached in `indexCacheDir` (built on first use, see
+  // FmIndex); other queries, and ones with millions of hits, still use the scan.
+  bool useIndex{false};
+  std::string indexCacheDir{"resources/mm2_index"};
+  // Polled before each chunk (and during an FM-index build): once it reads true no further hits
+  // are reported, and a build in progress is abandoned with an exception.
+  const std::atomic<bool>* cancel{nullptr};
+};
+
+// Receives hits in file order, then by position (forward before reverse at the same position);
+// approximate hits are ordered by end. Calls are serialised; returning false stops the search.
+using SearchSink = std::function<bool(const std::vector<SearchHit>& batch)>;
+
+// Exact, case-insensitive substring search. Sequences are cut into chunks that are searched in
+// parallel with positioned reads through the .fai (or .gnseq / .gzi) index, so memory stays at
+// one chunk per worker. Both strands are matched in the same SIMD pass (see findPatternPair).
+//
+// With maxEdits, each strand is matched by an EditMatcher and one hit is reported per occurrence
+// (the best end, then the start of its best alignment). When the query splits into maxEdits + 1
+// pieces of at least 12 bases, only the neighbourhoods of exact piece matches are aligned, since
+// every occurrence contains one of them unchanged.
+void searchFasta(const std::string& fastaPath,
+                 const std::string& query,
+                 const SearchOptions& options,
+                 const SearchSink& sink);
+std::vector<SearchHit> searchFasta(const std::string& fastaPath,
+                                   const std::string& query,
+                                   const SearchOptions& options = {});
+
+// Number of hits searchFasta would report (at most maxHits). With useIndex, exact ACGT-only
+// queries are counted from the FM-index without locating a single hit.
+std::size_t countFastaHits(const std::string& fastaPath, const std::string& query, const SearchOptions& options = {});
+
+// Tab-separated lines: name, start, end (0-based, half-open), strand (+/-), then the edit count
+// when `withEdits` is set.
+void writeSearchHits(std::ostream& out, const std::vector<SearchHit>& hits, bool withEdits = false);
+
+}  // namespace gapneedle
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// C entry point to gapneedle::reverseComplementInPlace for the minimap2 bridge.
+void gn_seq_reverse_complement_inplace(char* seq, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
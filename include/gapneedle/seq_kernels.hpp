@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+namespace gapneedle {
+
+// Byte-level sequence kernels. Each call dispatches once per process to the widest
+// implementation the CPU supports (AVX2, SSE4.1, then portable scalar code).
+
+// Complement is taken after uppercasing; anything outside ACGT becomes 'N'.
+void reverseComplementInto(const char* in, std::size_t n, char* out);
+void reverseComplementInPlace(char* seq, std::size_t n);
+
+void toUpperInto(const char* in, std::size_t n, char* out);
+void toUpperInPlace(char* seq, std::size_t n);
+
+// Copies `in` to `out` uppercased, dropping whitespace (spaces, tabs, CR, LF, ...).
+// Returns the number of bytes written; `out` must have room for `n` bytes.
+std::size_t copyUpperStripWhitespace(const char* in, std::size_t n, char* out);
+
+// Gap scanning: 'N' bytes, plus soft-masked 'n' when `caseInsensitive`.
+// Offset of the first gap byte in [in, in + n), or n when there is none.
+std::size_t findGapBase(const char* in, std::size_t n, bool caseInsensitive);
+// Length of the run of gap bytes at the start of [in, in + n).
+std::size_t gapRunLength(const char* in, std::size_t n, bool caseInsensitive);
+
+// Offset of the first i in [0, n) where [in + i, in + i + m) equals `first` or `second` (both m >= 1
+// bytes long), or n when there is none. Reads in[0 .. n + m - 2]. Pass the same pattern twice to
+// look for one pattern only.
+std::size_t findPatternPair(const char* in, std::size_t n, const char* first, const char* second, std::size_t m);
+
+// Name of the implementation selected at runtime ("avx2", "sse4.1" or "scalar").
+const char* seqKernelIsa();
+
+}  // namespace gapneedle
@@ -1,14 +1,56 @@
 #pragma once
 
+#include "gapneedle/motif_scanner.hpp"
+#include "gapneedle/types.hpp"
+
+#include <ostream>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace gapneedle {
 
 std::pair<bool, bool> checkTelomere(const std::string& fastaPath,
                                     const std::string& seqName,
-                                    int window = 1000000,
+                                    SeqPos window = 1000000,
                                     const std::string& motif = "CCCTAA",
                                     int minRepeats = 15);
 
+struct TelomereScanOptions {
+  SeqPos window{1000000};  // bases examined at each end
+  // Matched on both strands in one pass, e.g. {"CCCTAA"} (vertebrates), {"CCCTAAA"} (plants),
+  // {"CCTAA"} (insects), or several at once.
+  std::vector<std::string> motifs{"CCCTAA"};
+  int minRepeats{15};
+  SeqPos binBases{10000};  // density profile resolution; 0 disables the profile
+  unsigned threads{0};     // 0 = hardware concurrency
+};
+
+struct TelomereEndReport {
+  SeqPos windowBases{0};
+  SeqPos repeatCount{0};  // copies of all motifs (either strand) in the window
+  SeqPos longestRun{0};   // most consecutive copies of any one motif strand
+  bool hasTelomere{false};  // longestRun >= minRepeats
+  // Fraction of each bin covered by motif copies, ordered from the sequence end inwards.
+  std::vector<double> density;
+  std::vector<MotifRunStats> motifs;  // per motif, in the order of TelomereReport::motifs
+};
+
+struct TelomereReport {
+  std::string seqName;
+  SeqPos length{0};
+  std::vector<std::string> motifs;  // uppercased, duplicates merged
+  TelomereEndReport left;
+  TelomereEndReport right;
+};
+
+// Checks both ends of every sequence in one pass (sequences in parallel, end windows only).
+// Reports come back in file order.
+std::vector<TelomereReport> scanTelomeres(const std::string& fastaPath, const TelomereScanOptions& options = {});
+
+// One row per sequence end: name, length, end, window, repeats, longest run, telomere, density,
+// then per-motif `MOTIF:copies:longest_run` entries.
+void writeTelomereTsv(std::ostream& out, const std::vector<TelomereReport>& reports);
+void writeTelomereJson(std::ostream& out, const std::vector<TelomereReport>& reports);
+
 }  // namespace gapneedle
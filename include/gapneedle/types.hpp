@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -7,6 +8,9 @@
 
 namespace gapneedle {
 
+// Sequence coordinates and lengths. 64-bit so single sequences may exceed 2^31 bp.
+using SeqPos = std::int64_t;
+
 struct AlignmentRequest {
   std::string targetFasta;
   std::string queryFasta;
@@ -22,19 +26,21 @@ struct AlignmentRequest {
   std::string outputPafPath;
 };
 
+// Fields are grouped by width (strings, 64-bit positions, then the small ones) so the record
+// carries no interior padding.
 struct AlignmentRecord {
   std::string qName;
-  int qLen{0};
-  int qStart{0};
-  int qEnd{0};
-  char strand{'+'};
   std::string tName;
-  int tLen{0};
-  int tStart{0};
-  int tEnd{0};
-  int matches{0};
-  int alnLen{0};
+  SeqPos qLen{0};
+  SeqPos qStart{0};
+  SeqPos qEnd{0};
+  SeqPos tLen{0};
+  SeqPos tStart{0};
+  SeqPos tEnd{0};
+  SeqPos matches{0};
+  SeqPos alnLen{0};
   int mapq{0};
+  char strand{'+'};
   std::vector<std::string> extras;
 };
 
@@ -47,8 +53,8 @@ struct AlignmentResult {
 struct Segment {
   std::string source;   // t, q, x1...
   std::string seqName;
-  int start{0};
-  int end{0};
+  SeqPos start{0};
+  SeqPos end{0};
   bool reverse{false};
 };
 
@@ -77,38 +83,38 @@ struct StitchResult {
 };
 
 struct MappingResult {
-  std::optional<int> tPos;
+  std::optional<SeqPos> tPos;
   std::string reason;
-  int qPos{0};
-  std::optional<int> qPosOriented;
+  SeqPos qPos{0};
+  std::optional<SeqPos> qPosOriented;
+  SeqPos opLen{0};
+  SeqPos opOffset{0};
+  std::unordered_map<char, SeqPos> countsBefore;
+  std::unordered_map<char, SeqPos> countsTotal;
+  SeqPos qConsumedBefore{0};
+  SeqPos tConsumedBefore{0};
   char op{0};
-  int opLen{0};
-  int opOffset{0};
-  std::unordered_map<char, int> countsBefore;
-  std::unordered_map<char, int> countsTotal;
-  int qConsumedBefore{0};
-  int tConsumedBefore{0};
 };
 
 struct GuidedConstraints {
-  int nearZeroWindow{1000};
-  int maxJumpBp{200000};
-  int minProgressBp{200};
+  SeqPos nearZeroWindow{1000};
+  SeqPos maxJumpBp{200000};
+  SeqPos minProgressBp{200};
   int maxSteps{120};
 };
 
 struct GuidedCandidate {
   Segment segment;
   std::string recordId;
-  int axisStart{0};   // target-axis start
-  int axisEnd{0};     // target-axis end
-  int unclippedAxisEnd{0};
-  int clippedAt{-1};
-  int supportCount{0};
-  bool fallbackNearZero{false};
-  double score{0.0};
   std::string group;      // strong / acceptable / risk
   std::string rationale;  // short explanation for UI
+  SeqPos axisStart{0};    // target-axis start
+  SeqPos axisEnd{0};      // target-axis end
+  SeqPos unclippedAxisEnd{0};
+  SeqPos clippedAt{-1};
+  double score{0.0};
+  int supportCount{0};
+  bool fallbackNearZero{false};
 };
 
 struct GuidedSeedRequest {
@@ -123,7 +129,7 @@ struct GuidedStepRequest {
   std::string pafPath;
   std::string targetSeq;
   std::string querySeq;
-  int lastAxisEnd{0};
+  SeqPos lastAxisEnd{0};
   int lastChosenIndex{-1};
   std::vector<Segment> chosenPath;
   int maxNext{12};
@@ -1,6 +1,9 @@
 #include "gapneedle/facade.hpp"
+#include "gapneedle/fasta_io.hpp"
 #include "gapneedle/telomere_service.hpp"
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <string>
@@ -50,11 +53,14 @@ std::vector<std::string> getMany(const std::unordered_map<std::string, std::vect
 }
 
 void printUsage() {
-  std::cout << "gapneedle_cli --cmd <align|stitch|scan-gaps|check-telomere|guided-seed|guided-next> [options]\n"
+  std::cout << "gapneedle_cli --cmd <align|stitch|scan-gaps|pack-gnseq|check-telomere|scan-telomeres|search|guided-seed|guided-next> [options]\n"
             << "  align: --target-fasta --query-fasta --target-seq --query-seq [--output] [--preset] [--threads] [--index-cache-dir] [--no-index-cache]\n"
             << "  stitch: --target-fasta --query-fasta --output --segment src:name:start:end[:rc] (repeatable)\n"
-            << "  scan-gaps: --target-fasta [--min-gap]\n"
+            << "  scan-gaps: --target-fasta [--min-gap] [--seq-name] [--start] [--end] [--case-sensitive] [--bed] [--no-gap-index] [--threads]\n"
+            << "  pack-gnseq: --target-fasta --output (binary .gnseq container for fast reopening)\n"
             << "  check-telomere: --target-fasta --seq-name\n"
+            << "  scan-telomeres: --target-fasta [--window] [--motif (repeatable)] [--min-repeats] [--bin-size] [--threads] [--format tsv|json] [--output]\n"
+            << "  search: --target-fasta --query [--forward-only] [--max-edits] [--max-hits] [--threads] [--index] [--index-cache-dir] [--count] [--output]\n"
             << "  guided-seed: --paf --target-seq --query-seq [--max-seeds] [--near-zero-window]\n"
             << "  guided-next: --paf --target-seq --query-seq --last-axis-end [--max-next] [--max-jump-bp] [--min-progress-bp]\n";
 }
@@ -113,8 +119,8 @@ int main(int argc, char* argv[]) {
         Segment seg;
         seg.source = parts[0];
         seg.seqName = parts[1];
-        seg.start = std::stoi(parts[2]);
-        seg.end = std::stoi(parts[3]);
+        seg.start = std::stoll(parts[2]);
+        seg.end = std::stoll(parts[3]);
         seg.reverse = (parts.size() > 4 && parts[4] == "rc");
         req.segments.push_back(seg);
       }
@@ -124,20 +130,138 @@ int main(int argc, char* argv[]) {
       std::cout << "Session log: " << r.outputLogPath << "\n";
       std::cout << "Merged length: " << r.mergedLength << "\n";
     } else if (cmd == "scan-gaps") {
-      auto gaps = facade.scanGaps(getOne(opts, "--target-fasta"), std::stoi(getOne(opts, "--min-gap", "10")));
-      for (const auto& [name, s, e] : gaps) {
-        std::cout << name << "\t" << s << "\t" << e << "\n";
+      const std::string fasta = getOne(opts, "--target-fasta");
+      gapneedle::GapQuery query;
+      query.seqName = getOne(opts, "--seq-name");
+      query.start = std::stoll(getOne(opts, "--start", "0"));
+      query.end = std::stoll(getOne(opts, "--end", "-1"));
+      query.minGap = std::stoll(getOne(opts, "--min-gap", "10"));
+      query.caseInsensitive = getOne(opts, "--case-sensitive") != "true";
+      const std::string bedPath = getOne(opts, "--bed");
+      std::ofstream bed;
+      if (!bedPath.empty()) {
+        bed.open(bedPath, std::ios::trunc);
+        if (!bed) {
+          throw std::runtime_error("Failed to write BED: " + bedPath);
+        }
+      }
+      std::ostream& out = bedPath.empty() ? std::cout : bed;
+      if (getOne(opts, "--no-gap-index") == "true") {
+        gapneedle::GapScanOptions scan;
+        scan.minGap = query.minGap;
+        scan.caseInsensitive = query.caseInsensitive;
+        scan.threads = static_cast<unsigned>(std::stoul(getOne(opts, "--threads", "0")));
+        // Each sequence is printed as soon as it (and every sequence before it) has been scanned.
+        facade.scanGaps(fasta, scan, [&](const std::string& name, const std::vector<gapneedle::GapRecord>& gaps) {
+          if (!query.seqName.empty() && name != query.seqName) {
+            return;
+          }
+          std::vector<gapneedle::GapRecord> kept;
+          for (const auto& g : gaps) {
+            if (g.end > query.start && (query.end < 0 || g.start < query.end)) {
+              kept.push_back(g);
+            }
+          }
+          gapneedle::writeGapsBed(out, kept);
+          out.flush();
+        });
+      } else {
+        gapneedle::writeGapsBed(out, facade.queryGaps(fasta, query));
+      }
+      if (!bedPath.empty()) {
+        std::cout << "BED: " << bedPath << "\n";
       }
+    } else if (cmd == "pack-gnseq") {
+      const std::string input = getOne(opts, "--target-fasta");
+      const std::string output = getOne(opts, "--output", input + ".gnseq");
+      gapneedle::writeGnseq(input, output);
+      std::cout << "GNSEQ: " << output << "\n";
     } else if (cmd == "check-telomere") {
       auto [left, right] = gapneedle::checkTelomere(getOne(opts, "--target-fasta"), getOne(opts, "--seq-name"));
       std::cout << "left=" << (left ? "true" : "false") << " right=" << (right ? "true" : "false") << "\n";
+    } else if (cmd == "scan-telomeres") {
+      gapneedle::TelomereScanOptions scan;
+      scan.window = std::stoll(getOne(opts, "--window", "1000000"));
+      // --motif is repeatable and also takes comma-separated lists.
+      std::vector<std::string> motifs;
+      for (const auto& arg : getMany(opts, "--motif")) {
+        std::size_t from = 0;
+        while (from <= arg.size()) {
+          const auto comma = std::min(arg.find(',', from), arg.size());
+          if (comma > from) {
+            motifs.push_back(arg.substr(from, comma - from));
+          }
+          from = comma + 1;
+        }
+      }
+      if (!motifs.empty()) {
+        scan.motifs = motifs;
+      }
+      scan.minRepeats = std::stoi(getOne(opts, "--min-repeats", "15"));
+      scan.binBases = std::stoll(getOne(opts, "--bin-size", "10000"));
+      scan.threads = static_cast<unsigned>(std::stoul(getOne(opts, "--threads", "0")));
+      const std::string format = getOne(opts, "--format", "tsv");
+      if (format != "tsv" && format != "json") {
+        throw std::runtime_error("Unknown --format (expected tsv or json): " + format);
+      }
+      const auto reports = gapneedle::scanTelomeres(getOne(opts, "--target-fasta"), scan);
+      const std::string outPath = getOne(opts, "--output");
+      std::ofstream file;
+      if (!outPath.empty()) {
+        file.open(outPath, std::ios::trunc);
+        if (!file) {
+          throw std::runtime_error("Failed to write telomere report: " + outPath);
+        }
+      }
+      std::ostream& out = outPath.empty() ? std::cout : file;
+      if (format == "json") {
+        gapneedle::writeTelomereJson(out, reports);
+      } else {
+        gapneedle::writeTelomereTsv(out, reports);
+      }
+      if (!outPath.empty()) {
+        std::cout << "Report: " << outPath << "\n";
+      }
+    } else if (cmd == "search") {
+      gapneedle::SearchOptions search;
+      search.bothStrands = getOne(opts, "--forward-only") != "true";
+      search.maxEdits = static_cast<unsigned>(std::stoul(getOne(opts, "--max-edits", "0")));
+      search.maxHits = static_cast<std::size_t>(std::stoull(getOne(opts, "--max-hits", "0")));
+      search.threads = static_cast<unsigned>(std::stoul(getOne(opts, "--threads", "0")));
+      search.useIndex = getOne(opts, "--index") == "true";
+      search.indexCacheDir = getOne(opts, "--index-cache-dir", "resources/mm2_index");
+      if (getOne(opts, "--count") == "true") {
+        std::cout << "Hits: " << facade.countSearchHits(getOne(opts, "--target-fasta"), getOne(opts, "--query"), search)
+                  << "\n";
+        return 0;
+      }
+      const std::string outPath = getOne(opts, "--output");
+      std::ofstream file;
+      if (!outPath.empty()) {
+        file.open(outPath, std::ios::trunc);
+        if (!file) {
+          throw std::runtime_error("Failed to write search hits: " + outPath);
+        }
+      }
+      std::ostream& out = outPath.empty() ? std::cout : file;
+      std::size_t count = 0;
+      facade.search(getOne(opts, "--target-fasta"), getOne(opts, "--query"), search,
+                    [&](const std::vector<gapneedle::SearchHit>& batch) {
+                      gapneedle::writeSearchHits(out, batch, search.maxEdits > 0);
+                      count += batch.size();
+                      return static_cast<bool>(out);
+                    });
+      if (!outPath.empty()) {
+        std::cout << "Hits: " << count << "\n";
+        std::cout << "Output: " << outPath << "\n";
+      }
     } else if (cmd == "guided-seed") {
       gapneedle::GuidedSeedRequest req;
       req.pafPath = getOne(opts, "--paf");
       req.targetSeq = getOne(opts, "--target-seq");
       req.querySeq = getOne(opts, "--query-seq");
       req.maxSeeds = std::stoi(getOne(opts, "--max-seeds", "12"));
-      req.constraints.nearZeroWindow = std::stoi(getOne(opts, "--near-zero-window", "1000"));
+      req.constraints.nearZeroWindow = std::stoll(getOne(opts, "--near-zero-window", "1000"));
 
       auto r = facade.guidedSeed(req);
       for (const auto& w : r.warnings) {
@@ -159,10 +283,10 @@ int main(int argc, char* argv[]) {
       req.pafPath = getOne(opts, "--paf");
       req.targetSeq = getOne(opts, "--target-seq");
       req.querySeq = getOne(opts, "--query-seq");
-      req.lastAxisEnd = std::stoi(getOne(opts, "--last-axis-end", "0"));
+      req.lastAxisEnd = std::stoll(getOne(opts, "--last-axis-end", "0"));
       req.maxNext = std::stoi(getOne(opts, "--max-next", "12"));
-      req.constraints.maxJumpBp = std::stoi(getOne(opts, "--max-jump-bp", "200000"));
-      req.constraints.minProgressBp = std::stoi(getOne(opts, "--min-progress-bp", "200"));
+      req.constraints.maxJumpBp = std::stoll(getOne(opts, "--max-jump-bp", "200000"));
+      req.constraints.minProgressBp = std::stoll(getOne(opts, "--min-progress-bp", "200"));
 
       auto r = facade.guidedNext(req);
       std::cout << "exhausted=" << (r.exhausted ? "true" : "false") << "\n";
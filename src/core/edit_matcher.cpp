@@ -0,0 +1,201 @@
+#include "gapneedle/edit_matcher.hpp"
+
+#include "gapneedle/seq_kernels.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <stdexcept>
+
+namespace gapneedle {
+
+namespace {
+
+constexpr std::uint8_t kOther = 4;
+constexpr std::size_t kCodes = 5;
+
+const std::array<std::uint8_t, 256>& baseCodes() {
+  static const std::array<std::uint8_t, 256> codes = [] {
+    std::array<std::uint8_t, 256> t{};
+    t.fill(kOther);
+    t['A'] = t['a'] = 0;
+    t['C'] = t['c'] = 1;
+    t['G'] = t['g'] = 2;
+    t['T'] = t['t'] = 3;
+    return t;
+  }();
+  return codes;
+}
+
+// Turns the distance at each end, in order, into the hits described at EditMatcher::scan.
+class MinimaTracker {
+ public:
+  MinimaTracker(unsigned maxEdits, std::size_t from, std::size_t to, const EditMatcher::HitCallback& onHit)
+      : maxEdits_(maxEdits), from_(from), to_(to), onHit_(onHit) {}
+
+  // Distance at end j; the decision for end j - 1 needs both of its neighbours.
+  void push(std::size_t j, std::size_t distance) {
+    if (distance > maxEdits_ && d1_ > maxEdits_) {
+      d2_ = d1_;  // the common case: nowhere near a hit
+      return;
+    }
+    const unsigned d = static_cast<unsigned>(std::min<std::size_t>(distance, maxEdits_ + 1));
+    if (d1_ <= maxEdits_ && d1_ < d2_ && d1_ <= d && j - 1 >= from_ && j - 1 <= to_) {
+      onHit_(j - 1, d1_);
+    }
+    d2_ = d1_;
+    d1_ = d;
+  }
+
+  // The text ends at n: nothing follows the last end.
+  void finish(std::size_t n) { push(n + 1, maxEdits_ + 1); }
+
+ private:
+  unsigned maxEdits_;
+  std::size_t from_;
+  std::size_t to_;
+  const EditMatcher::HitCallback& onHit_;
+  unsigned d1_{std::numeric_limits<unsigned>::max()};  // end j - 1, capped at maxEdits + 1 (end 0 is never a hit)
+  unsigned d2_{std::numeric_limits<unsigned>::max()};  // end j - 2
+};
+
+}  // namespace
+
+EditMatcher::EditMatcher(const std::string& pattern, unsigned maxEdits)
+    : pattern_(pattern), length_(pattern.size()), maxEdits_(maxEdits) {
+  if (pattern_.empty()) {
+    throw std::runtime_error("Search query must not be empty");
+  }
+  if (maxEdits_ >= length_) {
+    throw std::runtime_error("Edit limit must be smaller than the query length");
+  }
+  toUpperInPlace(pattern_.data(), pattern_.size());
+  words_ = (length_ + 63) / 64;
+  peq_.assign(kCodes * words_, 0);
+  const auto& codes = baseCodes();
+  for (std::size_t i = 0; i < length_; ++i) {
+    const std::uint8_t c = codes[static_cast<unsigned char>(pattern_[i])];
+    if (c != kOther) {
+      peq_[c * words_ + i / 64] |= std::uint64_t{1} << (i % 64);
+    }
+  }
+}
+
+void EditMatcher::scan(const char* text,
+                       std::size_t n,
+                       std::size_t from,
+                       std::size_t to,
+                       const HitCallback& onHit) const {
+  if (words_ > 1) {
+    scanWords(text, n, from, to, onHit);
+    return;
+  }
+  const auto& codes = baseCodes();
+  MinimaTracker tracker(maxEdits_, from, to, onHit);
+  const std::size_t last = to < n ? to + 1 : n;  // the column after `to` decides it
+  const std::uint64_t high = std::uint64_t{1} << (length_ - 1);
+  std::uint64_t pv = ~std::uint64_t{0};
+  std::uint64_t mv = 0;
+  std::size_t distance = length_;
+  for (std::size_t j = 0; j < last; ++j) {
+    const std::uint64_t eq = peq_[codes[static_cast<unsigned char>(text[j])]];
+    const std::uint64_t xv = eq | mv;
+    const std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    std::uint64_t ph = mv | ~(xh | pv);
+    std::uint64_t mh = pv & xh;
+    // Branch-free: the sign of the last row's delta is close to random on unrelated sequence.
+    distance += static_cast<std::size_t>((ph & high) != 0);
+    distance -= static_cast<std::size_t>((mh & high) != 0);
+    // Row 0 is all zeros (an occurrence may start anywhere), so nothing is shifted in.
+    ph <<= 1;
+    mh <<= 1;
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+    tracker.push(j + 1, distance);
+  }
+  if (last == n) {
+    tracker.finish(n);
+  }
+}
+
+void EditMatcher::scanWords(const char* text,
+                            std::size_t n,
+                            std::size_t from,
+                            std::size_t to,
+                            const HitCallback& onHit) const {
+  const auto& codes = baseCodes();
+  MinimaTracker tracker(maxEdits_, from, to, onHit);
+  const std::size_t last = to < n ? to + 1 : n;
+  const std::uint64_t lastRow = std::uint64_t{1} << ((length_ - 1) % 64);
+  std::vector<std::uint64_t> pv(words_, ~std::uint64_t{0});
+  std::vector<std::uint64_t> mv(words_, 0);
+  std::size_t distance = length_;
+  for (std::size_t j = 0; j < last; ++j) {
+    const std::uint64_t* eqs = peq_.data() + codes[static_cast<unsigned char>(text[j])] * words_;
+    // Horizontal delta entering each block from the one above; 0 into the first (free start).
+    int hin = 0;
+    for (std::size_t b = 0; b < words_; ++b) {
+      const std::uint64_t hinNeg = hin < 0 ? 1 : 0;
+      std::uint64_t eq = eqs[b];
+      const std::uint64_t xv = eq | mv[b];
+      eq |= hinNeg;
+      const std::uint64_t xh = (((eq & pv[b]) + pv[b]) ^ pv[b]) | eq;
+      std::uint64_t ph = mv[b] | ~(xh | pv[b]);
+      std::uint64_t mh = pv[b] & xh;
+      const std::uint64_t out = b + 1 == words_ ? lastRow : std::uint64_t{1} << 63;
+      const int hout = (ph & out) ? 1 : (mh & out) ? -1 : 0;
+      ph = (ph << 1) | (hin > 0 ? 1 : 0);
+      mh = (mh << 1) | hinNeg;
+      pv[b] = mh | ~(xv | ph);
+      mv[b] = ph & xv;
+      hin = hout;
+    }
+    distance = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(distance) + hin);
+    tracker.push(j + 1, distance);
+  }
+  if (last == n) {
+    tracker.finish(n);
+  }
+}
+
+std::size_t EditMatcher::alignStart(const char* text, std::size_t end) const {
+  // Banded DP from the end backwards: row i is the last i pattern bases, column j the j text
+  // bases before `end`; only |i - j| <= maxEdits can stay within the limit.
+  const auto& codes = baseCodes();
+  const std::size_t m = length_;
+  const std::size_t k = maxEdits_;
+  const std::size_t maxJ = std::min(end, m + k);
+  constexpr unsigned kInf = std::numeric_limits<unsigned>::max() / 2;
+  std::vector<unsigned> prev(maxJ + 1, kInf);
+  std::vector<unsigned> cur(maxJ + 1, kInf);
+  for (std::size_t j = 0; j <= std::min(maxJ, k); ++j) prev[j] = static_cast<unsigned>(j);
+  for (std::size_t i = 1; i <= m; ++i) {
+    const std::uint8_t pc = codes[static_cast<unsigned char>(pattern_[m - i])];
+    const std::size_t lo = i > k ? i - k : 0;
+    const std::size_t hi = std::min(maxJ, i + k);
+    if (lo > 0) cur[lo - 1] = kInf;
+    for (std::size_t j = lo; j <= hi; ++j) {
+      if (j == 0) {
+        cur[0] = static_cast<unsigned>(i);
+        continue;
+      }
+      const std::uint8_t tc = codes[static_cast<unsigned char>(text[end - j])];
+      unsigned v = prev[j - 1] + (pc != kOther && pc == tc ? 0 : 1);
+      v = std::min(v, prev[j] + 1);
+      v = std::min(v, cur[j - 1] + 1);
+      cur[j] = v;
+    }
+    std::swap(prev, cur);
+  }
+
+  std::size_t best = m <= maxJ ? m : maxJ;
+  for (std::size_t j = m > k ? m - k : 0; j <= maxJ; ++j) {
+    const auto gap = [m](std::size_t x) { return x > m ? x - m : m - x; };
+    if (prev[j] < prev[best] || (prev[j] == prev[best] && (gap(j) < gap(best) || (gap(j) == gap(best) && j < best)))) {
+      best = j;
+    }
+  }
+  return end - best;
+}
+
+}  // namespace gapneedle
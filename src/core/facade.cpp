@@ -1,7 +1,5 @@
 #include "gapneedle/facade.hpp"
 
-#include "gapneedle/fasta_io.hpp"
-
 namespace gapneedle {
 
 GapNeedleFacade::GapNeedleFacade() = default;
@@ -14,31 +12,38 @@ StitchResult GapNeedleFacade::stitch(const StitchRequest& request) const {
   return stitchService_.stitch(request);
 }
 
-std::vector<std::tuple<std::string, int, int>> GapNeedleFacade::scanGaps(const std::string& fastaPath,
-                                                                          int minGap) const {
-  std::vector<std::tuple<std::string, int, int>> gaps;
-  auto records = readFasta(fastaPath);
-  for (const auto& [name, seq] : records) {
-    int start = -1;
-    for (int i = 0; i < static_cast<int>(seq.size()); ++i) {
-      if (seq[i] == 'N') {
-        if (start < 0) {
-          start = i;
-        }
-      } else {
-        if (start >= 0 && i - start >= minGap) {
-          gaps.emplace_back(name, start, i);
-        }
-        start = -1;
-      }
-    }
-    if (start >= 0 && static_cast<int>(seq.size()) - start >= minGap) {
-      gaps.emplace_back(name, start, static_cast<int>(seq.size()));
-    }
+std::vector<std::tuple<std::string, SeqPos, SeqPos>> GapNeedleFacade::scanGaps(const std::string& fastaPath,
+                                                                                SeqPos minGap) const {
+  GapScanOptions options;
+  options.minGap = minGap;
+  std::vector<std::tuple<std::string, SeqPos, SeqPos>> gaps;
+  for (auto& g : gapneedle::scanGaps(fastaPath, options)) {
+    gaps.emplace_back(std::move(g.seqName), g.start, g.end);
   }
   return gaps;
 }
 
+void GapNeedleFacade::scanGaps(const std::string& fastaPath, const GapScanOptions& options, const GapSink& sink) const {
+  gapneedle::scanGaps(fastaPath, options, sink);
+}
+
+std::vector<GapRecord> GapNeedleFacade::queryGaps(const std::string& fastaPath, const GapQuery& query) const {
+  return acquireGapIndex(fastaPath, query.caseInsensitive)->query(query);
+}
+
+void GapNeedleFacade::search(const std::string& fastaPath,
+                             const std::string& query,
+                             const SearchOptions& options,
+                             const SearchSink& sink) const {
+  searchFasta(fastaPath, query, options, sink);
+}
+
+std::size_t GapNeedleFacade::countSearchHits(const std::string& fastaPath,
+                                             const std::string& query,
+                                             const SearchOptions& options) const {
+  return countFastaHits(fastaPath, query, options);
+}
+
 GuidedSeedResult GapNeedleFacade::guidedSeed(const GuidedSeedRequest& request) const {
   return guidedStitchService_.seedCandidates(request);
 }
@@ -0,0 +1,571 @@
+#include "gapneedle/fm_index.hpp"
+
+#include "gapneedle/fasta_io.hpp"
+#include "gapneedle/seq_kernels.hpp"
+#include "io/fai_index.hpp"
+#include "io/mapped_file.hpp"
+#include "util/file_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace gapneedle {
+
+// File layout (host byte order, `byteOrder` rejects foreign files; every section is 8-aligned):
+//   Header
+//   SequenceEntry x sequenceCount
+//   names, padded to namesBytes
+//   Block x (textLength / 64 + 1)   rank data for BWT rows [64 b, 64 b + 64)
+//   uint64 x sampleCount            text positions of the sampled rows, in row order
+struct FmIndex::Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byteOrder;
+  std::uint64_t fastaSize;
+  std::int64_t fastaMtime;
+  std::uint64_t textLength;  // bases + one separator per sequence + terminator
+  std::uint64_t sequenceCount;
+  std::uint64_t namesBytes;
+  std::uint64_t sampleCount;
+  std::uint64_t firstRow[4];  // first BWT row of the suffixes starting with A, C, G, T
+};
+
+struct FmIndex::SequenceEntry {
+  std::uint64_t textStart;
+  std::uint64_t length;
+  std::uint64_t nameOffset;
+  std::uint64_t nameLength;
+};
+
+// One cache line of rank data: for each base, its count in the rows before this block and a bit
+// per row of the block; likewise for the rows whose text position is sampled.
+struct FmIndex::Block {
+  std::uint64_t rank[4];
+  std::uint64_t bits[4];
+  std::uint64_t sampleRank;
+  std::uint64_t sampleBits;
+};
+
+struct FmIndex::Storage {
+  MappedFile mapped;
+  std::string memory;  // used when the index file could not be written
+};
+
+namespace {
+
+constexpr char kFmIndexMagic[8] = {'G', 'N', 'F', 'M', 'I', 'D', 'X', '\n'};
+constexpr std::uint32_t kFmIndexVersion = 2;
+constexpr std::uint32_t kByteOrderMark = 0x01020304u;
+// Every base at a text position divisible by this is sampled, as is the first base of each ACGT
+// run (LF steps stop there), so locating a row takes at most this many steps.
+constexpr std::uint64_t kSampleRate = 32;
+constexpr std::uint8_t kTerminator = 0;
+constexpr std::uint8_t kSeparator = 5;  // also any base other than ACGT
+constexpr std::uint8_t kAlphabet = 6;
+
+inline int popcount64(std::uint64_t v) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  return static_cast<int>(__popcnt64(v));
+#else
+  return __builtin_popcountll(v);
+#endif
+}
+
+const std::array<std::uint8_t, 256>& textCodes() {
+  static const std::array<std::uint8_t, 256> codes = [] {
+    std::array<std::uint8_t, 256> t{};
+    t.fill(kSeparator);
+    t['A'] = t['a'] = 1;
+    t['C'] = t['c'] = 2;
+    t['G'] = t['g'] = 3;
+    t['T'] = t['t'] = 4;
+    return t;
+  }();
+  return codes;
+}
+
+bool isBase(std::uint8_t code) {
+  return code >= 1 && code <= 4;
+}
+
+std::int64_t mtimeKey(std::filesystem::file_time_type t) {
+  return static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count());
+}
+
+std::uint64_t alignTo8(std::uint64_t v) {
+  return (v + 7) & ~std::uint64_t{7};
+}
+
+void throwIfCancelled(const std::atomic<bool>* cancel) {
+  if (cancel != nullptr && cancel->load(std::memory_order_relaxed)) {
+    throw std::runtime_error("FM-index build cancelled");
+  }
+}
+
+// ---- Suffix array construction: SA-IS (Nong, Zhang & Chan), linear time ----
+
+template <typename Idx>
+constexpr Idx kEmpty = ~Idx{0};
+
+template <typename Char, typename Idx>
+void bucketBounds(const Char* s, Idx n, std::vector<Idx>& bkt, bool ends) {
+  std::fill(bkt.begin(), bkt.end(), Idx{0});
+  for (Idx i = 0; i < n; ++i) ++bkt[s[i]];
+  Idx sum = 0;
+  for (auto& b : bkt) {
+    sum += b;
+    b = ends ? sum : sum - b;
+  }
+}
+
+template <typename Char, typename Idx>
+void induceSort(const Char* s, Idx* sa, Idx n, const std::vector<bool>& stype, std::vector<Idx>& bkt) {
+  bucketBounds(s, n, bkt, false);
+  for (Idx i = 0; i < n; ++i) {
+    const Idx j = sa[i];
+    if (j != kEmpty<Idx> && j > 0 && !stype[j - 1]) sa[bkt[s[j - 1]]++] = j - 1;
+  }
+  bucketBounds(s, n, bkt, true);
+  for (Idx i = n; i-- > 0;) {
+    const Idx j = sa[i];
+    if (j != kEmpty<Idx> && j > 0 && stype[j - 1]) sa[--bkt[s[j - 1]]] = j - 1;
+  }
+}
+
+// Suffix array of s[0, n) over symbols [0, alphabet); s[n - 1] must be the unique smallest.
+// `cancel` is polled between the induced-sorting passes.
+template <typename Char, typename Idx>
+void sais(const Char* s, Idx* sa, Idx n, Idx alphabet, const std::atomic<bool>* cancel) {
+  if (n == 1) {
+    sa[0] = 0;
+    return;
+  }
+  std::vector<bool> stype(n);
+  stype[n - 1] = true;
+  for (Idx i = n - 1; i-- > 0;) stype[i] = s[i] < s[i + 1] || (s[i] == s[i + 1] && stype[i + 1]);
+  const auto isLms = [&stype](Idx i) { return i > 0 && stype[i] && !stype[i - 1]; };
+  std::vector<Idx> bkt(alphabet);
+
+  throwIfCancelled(cancel);
+  // 1. Sort the LMS substrings by inducing from LMS positions placed at their bucket ends.
+  std::fill(sa, sa + n, kEmpty<Idx>);
+  bucketBounds(s, n, bkt, true);
+  for (Idx i = 1; i < n; ++i) {
+    if (isLms(i)) sa[--bkt[s[i]]] = i;
+  }
+  induceSort(s, sa, n, stype, bkt);
+
+  throwIfCancelled(cancel);
+  // 2. Name them (equal substrings share a name) and build the reduced string at the end of sa.
+  Idx n1 = 0;
+  for (Idx i = 0; i < n; ++i) {
+    if (sa[i] != kEmpty<Idx> && isLms(sa[i])) sa[n1++] = sa[i];
+  }
+  std::fill(sa + n1, sa + n, kEmpty<Idx>);
+  Idx names = 0;
+  Idx prev = kEmpty<Idx>;
+  for (Idx i = 0; i < n1; ++i) {
+    const Idx pos = sa[i];
+    bool differ = prev == kEmpty<Idx>;
+    for (Idx d = 0; !differ; ++d) {
+      if (s[pos + d] != s[prev + d] || stype[pos + d] != stype[prev + d]) {
+        differ = true;
+      } else if (d > 0 && (isLms(pos + d) || isLms(prev + d))) {
+        break;
+      }
+    }
+    if (differ) {
+      ++names;
+      prev = pos;
+    }
+    sa[n1 + pos / 2] = names - 1;
+  }
+  for (Idx i = n, j = n; i-- > n1;) {
+    if (sa[i] != kEmpty<Idx>) sa[--j] = sa[i];
+  }
+
+  Idx* s1 = sa + n - n1;
+  if (names < n1) {
+    sais<Idx, Idx>(s1, sa, n1, names, cancel);
+  } else {
+    for (Idx i = 0; i < n1; ++i) sa[s1[i]] = i;
+  }
+
+  throwIfCancelled(cancel);
+  // 3. Seed the LMS suffixes in their now known order and induce the rest.
+  for (Idx i = 1, j = 0; i < n; ++i) {
+    if (isLms(i)) s1[j++] = i;
+  }
+  for (Idx i = 0; i < n1; ++i) sa[i] = s1[sa[i]];
+  std::fill(sa + n1, sa + n, kEmpty<Idx>);
+  bucketBounds(s, n, bkt, true);
+  for (Idx i = n1; i-- > 0;) {
+    const Idx j = sa[i];
+    sa[i] = kEmpty<Idx>;
+    sa[--bkt[s[j]]] = j;
+  }
+  induceSort(s, sa, n, stype, bkt);
+}
+
+// Only base positions are ever reached by textPosition, so separators and N runs cost nothing.
+bool sampled(const std::vector<std::uint8_t>& text, std::uint64_t pos) {
+  return isBase(text[pos]) && (pos % kSampleRate == 0 || !isBase(text[pos - 1]));
+}
+
+template <typename T>
+void appendRaw(std::string& out, const T* data, std::size_t count) {
+  out.append(reinterpret_cast<const char*>(data), count * sizeof(T));
+}
+
+template <typename Idx>
+void writeRankData(const std::vector<std::uint8_t>& text,
+                   const std::vector<Idx>& sa,
+                   std::string& out,
+                   const std::atomic<bool>* cancel) {
+  const std::uint64_t n = text.size();
+  std::uint64_t rank[4] = {0, 0, 0, 0};
+  std::uint64_t sampleRank = 0;
+  std::vector<std::uint64_t> samples;
+  samples.reserve(static_cast<std::size_t>(n / kSampleRate + 1));
+  for (std::uint64_t b = 0; b <= n / 64; ++b) {
+    if (b % (1u << 16) == 0) {
+      throwIfCancelled(cancel);
+    }
+    FmIndex::Block block{};
+    std::copy(rank, rank + 4, block.rank);
+    block.sampleRank = sampleRank;
+    for (std::uint64_t row = b * 64; row < std::min(n, b * 64 + 64); ++row) {
+      const std::uint64_t bit = std::uint64_t{1} << (row % 64);
+      const std::uint64_t pos = static_cast<std::uint64_t>(sa[static_cast<std::size_t>(row)]);
+      if (pos > 0 && isBase(text[static_cast<std::size_t>(pos - 1)])) {
+        const int c = text[static_cast<std::size_t>(pos - 1)] - 1;
+        block.bits[c] |= bit;
+        ++rank[c];
+      }
+      if (sampled(text, pos)) {
+        block.sampleBits |= bit;
+        samples.push_back(pos);
+        ++sampleRank;
+      }
+    }
+    appendRaw(out, &block, 1);
+  }
+  appendRaw(out, samples.data(), samples.size());
+}
+
+// Builds the whole index file in memory, sized up front so it is never reallocated.
+std::string buildFmIndex(const std::string& fastaPath,
+                         std::uint64_t fastaSize,
+                         std::int64_t fastaMtime,
+                         const std::atomic<bool>* cancel) {
+  FastaReaderOptions readerOptions;
+  readerOptions.useMmap = false;
+  readerOptions.blockCacheBytes = 0;
+  const FastaIndexedReader reader(fastaPath, readerOptions);
+  const std::vector<std::string> names = reader.listNames();
+
+  // Text: each sequence followed by a separator, then the terminator.
+  std::vector<FmIndex::SequenceEntry> entries;
+  std::uint64_t textLength = 1;
+  std::uint64_t nameBytes = 0;
+  for (const auto& name : names) {
+    const auto len = static_cast<std::uint64_t>(reader.length(name));
+    entries.push_back({textLength - 1, len, nameBytes, name.size()});
+    textLength += len + 1;
+    nameBytes += name.size();
+  }
+  std::vector<std::uint8_t> text(static_cast<std::size_t>(textLength), kSeparator);
+  const auto& codes = textCodes();
+  constexpr SeqPos kChunk = SeqPos{4} << 20;
+  std::string chunk;
+  for (std::size_t k = 0; k < names.size(); ++k) {
+    const auto len = static_cast<SeqPos>(entries[k].length);
+    for (SeqPos pos = 0; pos < len; pos += kChunk) {
+      throwIfCancelled(cancel);
+      chunk.resize(static_cast<std::size_t>(std::min(kChunk, len - pos)));
+      reader.fetchInto(names[k], pos, pos + static_cast<SeqPos>(chunk.size()), chunk.data());
+      std::uint8_t* dst = text.data() + entries[k].textStart + static_cast<std::uint64_t>(pos);
+      for (std::size_t i = 0; i < chunk.size(); ++i) dst[i] = codes[static_cast<unsigned char>(chunk[i])];
+    }
+  }
+  text.back() = kTerminator;
+
+  FmIndex::Header header{};
+  std::memcpy(header.magic, kFmIndexMagic, sizeof(kFmIndexMagic));
+  header.version = kFmIndexVersion;
+  header.byteOrder = kByteOrderMark;
+  header.fastaSize = fastaSize;
+  header.fastaMtime = fastaMtime;
+  header.textLength = textLength;
+  header.sequenceCount = entries.size();
+  header.namesBytes = alignTo8(nameBytes);
+  std::uint64_t symbolCounts[kAlphabet] = {};
+  for (std::uint64_t pos = 0; pos < textLength; ++pos) {
+    ++symbolCounts[text[static_cast<std::size_t>(pos)]];
+    header.sampleCount += sampled(text, pos) ? 1 : 0;
+  }
+  std::uint64_t row = symbolCounts[kTerminator];
+  for (int c = 0; c < 4; ++c) {
+    header.firstRow[c] = row;
+    row += symbolCounts[c + 1];
+  }
+
+  std::string out;
+  out.reserve(static_cast<std::size_t>(sizeof(header) + entries.size() * sizeof(FmIndex::SequenceEntry) +
+                                       header.namesBytes + (textLength / 64 + 1) * sizeof(FmIndex::Block) +
+                                       header.sampleCount * sizeof(std::uint64_t)));
+  appendRaw(out, &header, 1);
+  appendRaw(out, entries.data(), entries.size());
+  for (const auto& name : names) {
+    out += name;
+  }
+  out.append(static_cast<std::size_t>(header.namesBytes - nameBytes), '\0');
+
+  if (textLength <= std::numeric_limits<std::uint32_t>::max()) {
+    std::vector<std::uint32_t> sa(static_cast<std::size_t>(textLength));
+    sais<std::uint8_t, std::uint32_t>(text.data(), sa.data(), static_cast<std::uint32_t>(textLength), kAlphabet,
+                                      cancel);
+    writeRankData(text, sa, out, cancel);
+  } else {
+    std::vector<std::uint64_t> sa(static_cast<std::size_t>(textLength));
+    sais<std::uint8_t, std::uint64_t>(text.data(), sa.data(), textLength, kAlphabet, cancel);
+    writeRankData(text, sa, out, cancel);
+  }
+  return out;
+}
+
+// Variant: the cache directory.
+FilePool<FmIndex, std::string>& fmIndexPool() {
+  static FilePool<FmIndex, std::string> pool(4);
+  return pool;
+}
+
+}  // namespace
+
+FmIndex::FmIndex(const std::string& fastaPath, const std::string& indexPath, const std::atomic<bool>* cancel)
+    : storage_(std::make_unique<Storage>()) {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  const std::uint64_t size = fs::file_size(fastaPath, ec);
+  if (ec) {
+    throw std::runtime_error("Failed to open FASTA: " + fastaPath);
+  }
+  const std::int64_t mtime = mtimeKey(fs::last_write_time(fastaPath, ec));
+  if (open(indexPath, size, mtime)) {
+    loadedFromFile_ = true;
+    return;
+  }
+
+  storage_->memory = buildFmIndex(fastaPath, size, mtime, cancel);
+  const fs::path parent = fs::path(indexPath).parent_path();
+  if (!parent.empty()) {
+    fs::create_directories(parent, ec);
+  }
+  try {
+    writeFileAtomically(indexPath, storage_->memory);
+    if (open(indexPath, size, mtime)) {
+      std::string().swap(storage_->memory);
+      return;
+    }
+  } catch (const std::exception&) {
+    // Read-only or full cache location: keep the index in memory.
+  }
+  if (!attach(storage_->memory.data(), storage_->memory.size(), size, mtime)) {
+    throw std::runtime_error("Failed to build FM-index: " + fastaPath);
+  }
+}
+
+FmIndex::~FmIndex() = default;
+
+bool FmIndex::open(const std::string& indexPath, std::uint64_t fastaSize, std::int64_t fastaMtime) {
+  std::error_code ec;
+  if (!std::filesystem::is_regular_file(indexPath, ec)) {
+    return false;
+  }
+  try {
+    storage_->mapped = MappedFile(indexPath);
+  } catch (const std::exception&) {
+    return false;
+  }
+  return attach(storage_->mapped.data(), storage_->mapped.size(), fastaSize, fastaMtime);
+}
+
+bool FmIndex::attach(const char* data, std::size_t size, std::uint64_t fastaSize, std::int64_t fastaMtime) {
+  if (size < sizeof(Header)) {
+    return false;
+  }
+  const auto* header = reinterpret_cast<const Header*>(data);
+  if (std::memcmp(header->magic, kFmIndexMagic, sizeof(kFmIndexMagic)) != 0 || header->version != kFmIndexVersion ||
+      header->byteOrder != kByteOrderMark || header->fastaSize != fastaSize || header->fastaMtime != fastaMtime) {
+    return false;
+  }
+  // Bounded by the FASTA size so a corrupt header cannot overflow the size check below.
+  if (header->textLength == 0 || header->textLength > 2 * fastaSize + 2 || header->sequenceCount > fastaSize ||
+      header->namesBytes > fastaSize + 8 || header->sampleCount > header->textLength) {
+    return false;
+  }
+  const std::uint64_t blocksOffset =
+      sizeof(Header) + header->sequenceCount * sizeof(SequenceEntry) + header->namesBytes;
+  const std::uint64_t samplesOffset = blocksOffset + (header->textLength / 64 + 1) * sizeof(Block);
+  if (samplesOffset + header->sampleCount * sizeof(std::uint64_t) != size) {
+    return false;
+  }
+  header_ = header;
+  sequences_ = reinterpret_cast<const SequenceEntry*>(data + sizeof(Header));
+  names_ = data + sizeof(Header) + header->sequenceCount * sizeof(SequenceEntry);
+  blocks_ = reinterpret_cast<const Block*>(data + blocksOffset);
+  samples_ = reinterpret_cast<const std::uint64_t*>(data + samplesOffset);
+  return true;
+}
+
+bool FmIndex::supports(const std::string& query) {
+  const auto& codes = textCodes();
+  return !query.empty() && std::all_of(query.begin(), query.end(), [&codes](char c) {
+    return isBase(codes[static_cast<unsigned char>(c)]);
+  });
+}
+
+std::uint64_t FmIndex::occ(int code, std::uint64_t row) const {
+  const Block& block = blocks_[row / 64];
+  const std::uint64_t below = (std::uint64_t{1} << (row % 64)) - 1;
+  return block.rank[code] + static_cast<std::uint64_t>(popcount64(block.bits[code] & below));
+}
+
+void FmIndex::range(const std::string& pattern, std::uint64_t& sp, std::uint64_t& ep) const {
+  const auto& codes = textCodes();
+  sp = 0;
+  ep = header_->textLength;
+  for (auto it = pattern.rbegin(); it != pattern.rend() && sp < ep; ++it) {
+    const int c = codes[static_cast<unsigned char>(*it)] - 1;
+    sp = header_->firstRow[c] + occ(c, sp);
+    ep = header_->firstRow[c] + occ(c, ep);
+  }
+  ep = std::max(sp, ep);
+}
+
+std::uint64_t FmIndex::textPosition(std::uint64_t row) const {
+  // Walk backwards through the text (LF mapping) until a sampled row.
+  for (std::uint64_t steps = 0;; ++steps) {
+    const Block& block = blocks_[row / 64];
+    const std::uint64_t bit = std::uint64_t{1} << (row % 64);
+    if (block.sampleBits & bit) {
+      return samples_[block.sampleRank + static_cast<std::uint64_t>(popcount64(block.sampleBits & (bit - 1)))] + steps;
+    }
+    int c = 0;
+    while (c < 4 && !(block.bits[c] & bit)) ++c;
+    if (c == 4 || steps > kSampleRate) {
+      throw std::runtime_error("Corrupt FM-index");
+    }
+    row = header_->firstRow[c] + block.rank[c] + static_cast<std::uint64_t>(popcount64(block.bits[c] & (bit - 1)));
+  }
+}
+
+SeqPos FmIndex::count(const std::string& query) const {
+  if (!supports(query)) {
+    return 0;
+  }
+  std::string pattern = query;
+  toUpperInPlace(pattern.data(), pattern.size());
+  std::uint64_t sp = 0;
+  std::uint64_t ep = 0;
+  range(pattern, sp, ep);
+  return static_cast<SeqPos>(ep - sp);
+}
+
+std::vector<SearchHit> FmIndex::locate(const std::string& query, bool bothStrands) const {
+  if (!supports(query)) {
+    return {};
+  }
+  std::string fwd = query;
+  toUpperInPlace(fwd.data(), fwd.size());
+  std::vector<std::pair<std::string, bool>> patterns = {{fwd, false}};
+  if (bothStrands) {
+    std::string rc = reverseComplement(fwd);
+    if (rc != fwd) {
+      patterns.emplace_back(std::move(rc), true);
+    }
+  }
+
+  // (sequence, start, reverse), sorted into file order before names are attached.
+  std::vector<std::tuple<std::uint64_t, std::uint64_t, bool>> found;
+  for (const auto& [pattern, reverse] : patterns) {
+    std::uint64_t sp = 0;
+    std::uint64_t ep = 0;
+    range(pattern, sp, ep);
+    for (std::uint64_t row = sp; row < ep; ++row) {
+      const std::uint64_t pos = textPosition(row);
+      const SequenceEntry* end = sequences_ + header_->sequenceCount;
+      const SequenceEntry* seq =
+          std::upper_bound(sequences_, end, pos, [](std::uint64_t p, const SequenceEntry& e) { return p < e.textStart; }) - 1;
+      found.emplace_back(static_cast<std::uint64_t>(seq - sequences_), pos - seq->textStart, reverse);
+    }
+  }
+  std::sort(found.begin(), found.end());
+
+  std::vector<SearchHit> hits;
+  hits.reserve(found.size());
+  const auto q = static_cast<SeqPos>(fwd.size());
+  for (const auto& [seq, start, reverse] : found) {
+    const SequenceEntry& e = sequences_[seq];
+    hits.push_back(SearchHit{std::string(names_ + e.nameOffset, static_cast<std::size_t>(e.nameLength)),
+                             static_cast<SeqPos>(start), static_cast<SeqPos>(start) + q, reverse});
+  }
+  return hits;
+}
+
+std::string fmIndexPathOf(const std::string& fastaPath, const std::string& cacheDir) {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  const fs::path canonical = fs::weakly_canonical(fs::path(fastaPath), ec);
+  const std::string key = ec ? fastaPath : canonical.string();
+  const std::uint64_t size = fs::file_size(fastaPath, ec);
+  if (ec) {
+    throw std::runtime_error("Failed to open FASTA: " + fastaPath);
+  }
+  const std::int64_t mtime = mtimeKey(fs::last_write_time(fastaPath, ec));
+
+  // FNV-1a, as used for the minimap2 index cache names.
+  std::uint64_t h = 1469598103934665603ULL;
+  const auto mix = [&h](const void* data, std::size_t n) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < n; ++i) {
+      h ^= p[i];
+      h *= 1099511628211ULL;
+    }
+  };
+  const std::string tag = "gn_fm_index_v1|";
+  mix(tag.data(), tag.size());
+  mix(key.data(), key.size());
+  mix(&size, sizeof(size));
+  mix(&mtime, sizeof(mtime));
+  char hex[17];
+  std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(h));
+  return (fs::path(cacheDir) / (std::string(hex) + ".gnfm")).string();
+}
+
+std::shared_ptr<const FmIndex> acquireFmIndex(const std::string& fastaPath,
+                                              const std::string& cacheDir,
+                                              const std::atomic<bool>* cancel) {
+  // Opened (or built) without blocking lookups of other files (see FilePool::acquire).
+  return fmIndexPool().acquire(FileVersion::of(fastaPath), cacheDir, [&] {
+    return std::make_shared<const FmIndex>(fastaPath, fmIndexPathOf(fastaPath, cacheDir), cancel);
+  });
+}
+
+void clearFmIndexPool() {
+  fmIndexPool().clear();
+}
+
+}  // namespace gapneedle
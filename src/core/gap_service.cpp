@@ -0,0 +1,347 @@
+#include "gapneedle/gap_service.hpp"
+
+#include "gapneedle/fasta_io.hpp"
+#include "gapneedle/seq_kernels.hpp"
+#include "io/fai_index.hpp"
+#include "io/gnseq_file.hpp"
+#include "util/file_pool.hpp"
+#include "util/parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace gapneedle {
+
+namespace {
+
+// Bases handed to one visit() call; each worker buffers about this many bytes.
+constexpr SeqPos kScanWindowBases = SeqPos{4} << 20;
+
+std::vector<GapRecord> scanSequence(const FastaIndexedReader& reader,
+                                    const std::string& name,
+                                    const GapScanOptions& options) {
+  std::vector<GapRecord> gaps;
+  const SeqPos minGap = std::max<SeqPos>(options.minGap, 1);
+  const SeqPos len = reader.length(name);
+  SeqPos pos = 0;
+  SeqPos runStart = -1;
+  auto closeRun = [&](SeqPos end) {
+    if (end - runStart >= minGap) {
+      gaps.push_back(GapRecord{name, runStart, end});
+    }
+    runStart = -1;
+  };
+  const auto scanPiece = [&](std::string_view piece) {
+    // Runs may continue across line and window boundaries, so `runStart` carries over.
+    std::size_t i = 0;
+    while (i < piece.size()) {
+      if (runStart < 0) {
+        i += findGapBase(piece.data() + i, piece.size() - i, options.caseInsensitive);
+        if (i == piece.size()) break;
+        runStart = pos + static_cast<SeqPos>(i);
+      }
+      i += gapRunLength(piece.data() + i, piece.size() - i, options.caseInsensitive);
+      if (i < piece.size()) {
+        closeRun(pos + static_cast<SeqPos>(i));
+      }
+    }
+    pos += static_cast<SeqPos>(piece.size());
+  };
+  for (SeqPos w = 0; w < len; w += kScanWindowBases) {
+    reader.visit(name, w, std::min(len, w + kScanWindowBases), scanPiece);
+  }
+  if (runStart >= 0) {
+    closeRun(pos);
+  }
+  return gaps;
+}
+
+void scanGnseq(const std::string& path, const GapScanOptions& options, const GapSink& sink) {
+  // .gnseq keeps maximal runs of each non-ACGT base, so N gaps are a filter over that table.
+  const GnseqFile file(path);
+  const auto minGap = static_cast<std::uint64_t>(std::max<SeqPos>(options.minGap, 1));
+  std::vector<GapRecord> gaps;
+  for (std::size_t i = 0; i < file.count(); ++i) {
+    const std::string name(file.name(i));
+    gaps.clear();
+    const GnseqRun* runs = file.runs(i);
+    for (std::size_t k = 0; k < file.runCount(i); ++k) {
+      if (runs[k].base == 'N' && runs[k].length >= minGap) {
+        gaps.push_back(GapRecord{name, static_cast<SeqPos>(runs[k].start),
+                                 static_cast<SeqPos>(runs[k].start + runs[k].length)});
+      }
+    }
+    sink(name, gaps);
+  }
+}
+
+// Sidecar layout (host byte order, `byteOrder` rejects foreign files):
+//   GapIndexHeader
+//   per sequence: uint64 name length, name bytes, uint64 run count, run count x {int64 start, int64 end}
+struct GapIndexHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byteOrder;
+  std::uint64_t fastaSize;
+  std::int64_t fastaMtime;
+  std::uint32_t flags;
+  std::uint32_t reserved;
+  std::uint64_t sequenceCount;
+};
+static_assert(sizeof(GapIndexHeader) == 48, "GapIndexHeader layout");
+
+constexpr char kGapIndexMagic[8] = {'G', 'N', 'G', 'A', 'P', 'S', '\r', '\n'};
+constexpr std::uint32_t kGapIndexVersion = 1;
+constexpr std::uint32_t kByteOrderMark = 0x01020304u;
+constexpr std::uint32_t kFlagCaseInsensitive = 1u;
+
+std::int64_t mtimeKey(std::filesystem::file_time_type t) {
+  return static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count());
+}
+
+// Variant: caseInsensitive.
+FilePool<GapIndex, bool>& gapIndexPool() {
+  static FilePool<GapIndex, bool> pool(16);
+  return pool;
+}
+
+}  // namespace
+
+void scanGaps(const std::string& fastaPath, const GapScanOptions& options, const GapSink& sink) {
+  if (GnseqFile::isGnseq(fastaPath)) {
+    scanGnseq(fastaPath, options, sink);
+    return;
+  }
+
+  // Positioned reads into one window per worker rather than the mapping: a mapped scan would
+  // leave the whole file resident in this process.
+  FastaReaderOptions readerOptions;
+  readerOptions.useMmap = false;
+  readerOptions.blockCacheBytes = 0;
+  const FastaIndexedReader reader(fastaPath, readerOptions);
+  const std::vector<std::string> names = reader.listNames();
+
+  // Finished sequences wait here until every earlier one has been handed to the sink.
+  std::mutex mu;
+  std::vector<std::vector<GapRecord>> pending(names.size());
+  std::vector<char> done(names.size(), 0);
+  std::size_t nextToEmit = 0;
+  parallelFor(names.size(), options.threads, [&](std::size_t i) {
+    std::vector<GapRecord> gaps = scanSequence(reader, names[i], options);
+    std::lock_guard<std::mutex> lock(mu);
+    pending[i] = std::move(gaps);
+    done[i] = 1;
+    while (nextToEmit < names.size() && done[nextToEmit]) {
+      sink(names[nextToEmit], pending[nextToEmit]);
+      std::vector<GapRecord>().swap(pending[nextToEmit]);
+      ++nextToEmit;
+    }
+  });
+}
+
+std::vector<GapRecord> scanGaps(const std::string& fastaPath, const GapScanOptions& options) {
+  std::vector<GapRecord> all;
+  scanGaps(fastaPath, options, [&all](const std::string&, const std::vector<GapRecord>& gaps) {
+    all.insert(all.end(), gaps.begin(), gaps.end());
+  });
+  return all;
+}
+
+std::string gapIndexPathOf(const std::string& fastaPath, bool caseInsensitive) {
+  return fastaPath + (caseInsensitive ? ".gapidx" : ".cs.gapidx");
+}
+
+GapIndex::GapIndex(const std::string& fastaPath, bool caseInsensitive) {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  const std::uint64_t size = fs::file_size(fastaPath, ec);
+  if (ec) {
+    throw std::runtime_error("Failed to open FASTA: " + fastaPath);
+  }
+  const std::int64_t mtime = mtimeKey(fs::last_write_time(fastaPath, ec));
+  const std::string sidecar = gapIndexPathOf(fastaPath, caseInsensitive);
+  if (load(sidecar, size, mtime, caseInsensitive)) {
+    loadedFromSidecar_ = true;
+    return;
+  }
+
+  GapScanOptions options;
+  options.minGap = 1;
+  options.caseInsensitive = caseInsensitive;
+  scanGaps(fastaPath, options, [this](const std::string& name, const std::vector<GapRecord>& gaps) {
+    Sequence seq;
+    seq.name = name;
+    seq.runs.reserve(gaps.size());
+    for (const auto& g : gaps) {
+      seq.runs.push_back(Run{g.start, g.end});
+    }
+    addSequence(std::move(seq));
+  });
+  try {
+    save(sidecar, size, mtime, caseInsensitive);
+  } catch (const std::exception&) {
+    // Read-only location: keep serving from memory.
+  }
+}
+
+std::vector<std::string> GapIndex::names() const {
+  std::vector<std::string> out;
+  out.reserve(sequences_.size());
+  for (const auto& seq : sequences_) {
+    out.push_back(seq.name);
+  }
+  return out;
+}
+
+void GapIndex::addSequence(Sequence seq) {
+  seq.byLength.resize(seq.runs.size());
+  for (std::size_t i = 0; i < seq.runs.size(); ++i) {
+    seq.byLength[i] = static_cast<std::uint32_t>(i);
+  }
+  const auto& runs = seq.runs;
+  std::stable_sort(seq.byLength.begin(), seq.byLength.end(), [&runs](std::uint32_t a, std::uint32_t b) {
+    return runs[a].end - runs[a].start > runs[b].end - runs[b].start;
+  });
+  byName_.emplace(seq.name, sequences_.size());
+  sequences_.push_back(std::move(seq));
+}
+
+std::vector<GapRecord> GapIndex::query(const GapQuery& query) const {
+  std::vector<GapRecord> out;
+  if (query.seqName.empty()) {
+    for (const auto& seq : sequences_) {
+      collect(seq, query, out);
+    }
+    return out;
+  }
+  auto it = byName_.find(query.seqName);
+  if (it != byName_.end()) {
+    collect(sequences_[it->second], query, out);
+  }
+  return out;
+}
+
+void GapIndex::collect(const Sequence& seq, const GapQuery& query, std::vector<GapRecord>& out) const {
+  const SeqPos minGap = std::max<SeqPos>(query.minGap, 1);
+  const SeqPos start = std::max<SeqPos>(query.start, 0);
+  const SeqPos end = query.end < 0 ? std::numeric_limits<SeqPos>::max() : query.end;
+  const auto& runs = seq.runs;
+  if (start == 0 && query.end < 0) {
+    // Whole sequence: the runs long enough form a prefix of the length order.
+    const auto stop = std::partition_point(seq.byLength.begin(), seq.byLength.end(), [&](std::uint32_t i) {
+      return runs[i].end - runs[i].start >= minGap;
+    });
+    std::vector<std::uint32_t> hits(seq.byLength.begin(), stop);
+    std::sort(hits.begin(), hits.end());
+    for (const std::uint32_t i : hits) {
+      out.push_back(GapRecord{seq.name, runs[i].start, runs[i].end});
+    }
+    return;
+  }
+  auto it = std::partition_point(runs.begin(), runs.end(), [start](const Run& r) { return r.end <= start; });
+  for (; it != runs.end() && it->start < end; ++it) {
+    if (it->end - it->start >= minGap) {
+      out.push_back(GapRecord{seq.name, it->start, it->end});
+    }
+  }
+}
+
+bool GapIndex::load(const std::string& sidecarPath,
+                    std::uint64_t fastaSize,
+                    std::int64_t fastaMtime,
+                    bool caseInsensitive) {
+  std::ifstream in(sidecarPath, std::ios::binary);
+  GapIndexHeader header{};
+  if (!in || !in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    return false;
+  }
+  const std::uint32_t flags = caseInsensitive ? kFlagCaseInsensitive : 0u;
+  if (std::memcmp(header.magic, kGapIndexMagic, sizeof(kGapIndexMagic)) != 0 || header.version != kGapIndexVersion ||
+      header.byteOrder != kByteOrderMark || header.fastaSize != fastaSize || header.fastaMtime != fastaMtime ||
+      header.flags != flags) {
+    return false;
+  }
+  auto readU64 = [&in](std::uint64_t& v) { return static_cast<bool>(in.read(reinterpret_cast<char*>(&v), sizeof(v))); };
+  std::vector<Sequence> loaded;
+  for (std::uint64_t i = 0; i < header.sequenceCount; ++i) {
+    Sequence seq;
+    std::uint64_t nameLength = 0;
+    std::uint64_t runCount = 0;
+    if (!readU64(nameLength) || nameLength > fastaSize) return false;
+    seq.name.resize(static_cast<std::size_t>(nameLength));
+    if (!in.read(seq.name.data(), static_cast<std::streamsize>(nameLength)) || !readU64(runCount) ||
+        runCount > fastaSize) {
+      return false;
+    }
+    seq.runs.resize(static_cast<std::size_t>(runCount));
+    if (!in.read(reinterpret_cast<char*>(seq.runs.data()), static_cast<std::streamsize>(runCount * sizeof(Run)))) {
+      return false;
+    }
+    loaded.push_back(std::move(seq));
+  }
+  for (auto& seq : loaded) {
+    addSequence(std::move(seq));
+  }
+  return true;
+}
+
+void GapIndex::save(const std::string& sidecarPath,
+                    std::uint64_t fastaSize,
+                    std::int64_t fastaMtime,
+                    bool caseInsensitive) const {
+  static_assert(sizeof(Run) == 16, "Run is written as two int64 values");
+  GapIndexHeader header{};
+  std::memcpy(header.magic, kGapIndexMagic, sizeof(kGapIndexMagic));
+  header.version = kGapIndexVersion;
+  header.byteOrder = kByteOrderMark;
+  header.fastaSize = fastaSize;
+  header.fastaMtime = fastaMtime;
+  header.flags = caseInsensitive ? kFlagCaseInsensitive : 0u;
+  header.sequenceCount = sequences_.size();
+
+  const std::string tmp = temporaryPathFor(sidecarPath);
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    auto writeU64 = [&out](std::uint64_t v) { out.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& seq : sequences_) {
+      writeU64(seq.name.size());
+      out.write(seq.name.data(), static_cast<std::streamsize>(seq.name.size()));
+      writeU64(seq.runs.size());
+      out.write(reinterpret_cast<const char*>(seq.runs.data()),
+                static_cast<std::streamsize>(seq.runs.size() * sizeof(Run)));
+    }
+    out.close();
+    if (!out) {
+      std::error_code ec;
+      std::filesystem::remove(tmp, ec);
+      throw std::runtime_error("Failed to write gap index: " + sidecarPath);
+    }
+  }
+  publishTemporary(tmp, sidecarPath);
+}
+
+std::shared_ptr<const GapIndex> acquireGapIndex(const std::string& fastaPath, bool caseInsensitive) {
+  // A first scan does not block lookups of other files (see FilePool::acquire).
+  return gapIndexPool().acquire(FileVersion::of(fastaPath), caseInsensitive, [&] {
+    return std::make_shared<const GapIndex>(fastaPath, caseInsensitive);
+  });
+}
+
+void clearGapIndexPool() {
+  gapIndexPool().clear();
+}
+
+void writeGapsBed(std::ostream& out, const std::vector<GapRecord>& gaps) {
+  for (const auto& g : gaps) {
+    out << g.seqName << '\t' << g.start << '\t' << g.end << '\n';
+  }
+}
+
+}  // namespace gapneedle
@@ -75,7 +75,7 @@ std::vector<CandidateBuild> buildFromRecords(const std::vector<AlignmentRecord>&
   return out;
 }
 
-std::vector<CandidateBuild> buildSuffixFromRecords(const std::vector<AlignmentRecord>& recs, int lastAxisEnd) {
+std::vector<CandidateBuild> buildSuffixFromRecords(const std::vector<AlignmentRecord>& recs, SeqPos lastAxisEnd) {
   std::vector<CandidateBuild> out;
   out.reserve(recs.size() * 2);
   for (std::size_t i = 0; i < recs.size(); ++i) {
@@ -87,8 +87,8 @@ std::vector<CandidateBuild> buildSuffixFromRecords(const std::vector<AlignmentRe
       continue;
     }
 
-    const int suffixAxisStart = std::max(r.tStart, lastAxisEnd);
-    const int suffixAxisEnd = r.tEnd;
+    const SeqPos suffixAxisStart = std::max(r.tStart, lastAxisEnd);
+    const SeqPos suffixAxisEnd = r.tEnd;
     if (suffixAxisEnd <= suffixAxisStart) {
       continue;
     }
@@ -109,19 +109,19 @@ std::vector<CandidateBuild> buildSuffixFromRecords(const std::vector<AlignmentRe
     tCand.rationale = "suffix candidate from target axis";
     out.push_back(CandidateBuild{tCand});
 
-    const int tSpan = r.tEnd - r.tStart;
-    const int qSpan = r.qEnd - r.qStart;
+    const SeqPos tSpan = r.tEnd - r.tStart;
+    const SeqPos qSpan = r.qEnd - r.qStart;
     if (tSpan <= 0 || qSpan <= 0) {
       continue;
     }
-    auto mapAxisToQuery = [&](int axisPos) {
+    auto mapAxisToQuery = [&](SeqPos axisPos) {
       const double ratio = static_cast<double>(axisPos - r.tStart) / static_cast<double>(tSpan);
-      int q = r.qStart + static_cast<int>(std::lround(ratio * static_cast<double>(qSpan)));
+      SeqPos q = r.qStart + static_cast<SeqPos>(std::llround(ratio * static_cast<double>(qSpan)));
       q = std::max(r.qStart, std::min(r.qEnd, q));
       return q;
     };
-    int qStart = mapAxisToQuery(suffixAxisStart);
-    int qEnd = mapAxisToQuery(suffixAxisEnd);
+    SeqPos qStart = mapAxisToQuery(suffixAxisStart);
+    SeqPos qEnd = mapAxisToQuery(suffixAxisEnd);
     if (qEnd <= qStart) {
       qEnd = std::min(r.qEnd, qStart + 1);
     }
@@ -171,20 +171,20 @@ void mergeDuplicates(std::vector<CandidateBuild>* inout) {
 }
 
 double seedScore(const GuidedCandidate& c, const GuidedConstraints& cfg) {
-  const double d = static_cast<double>(std::max(0, c.axisStart));
+  const double d = static_cast<double>(std::max<SeqPos>(0, c.axisStart));
   const double near = 1.0 - clamp01(d / std::max(1.0, static_cast<double>(cfg.nearZeroWindow)));
   const double support = clamp01(static_cast<double>(c.supportCount) / 4.0);
-  const double len = clamp01(static_cast<double>(std::max(0, c.axisEnd - c.axisStart)) / 200000.0);
+  const double len = clamp01(static_cast<double>(std::max<SeqPos>(0, c.axisEnd - c.axisStart)) / 200000.0);
   return 0.45 * near + 0.35 * support + 0.20 * len;
 }
 
-double stepScore(const GuidedCandidate& c, int lastAxisEnd, const GuidedConstraints& cfg) {
-  const int progressBp = std::max(0, c.axisEnd - lastAxisEnd);
-  const int jumpBp = std::max(0, c.axisStart - lastAxisEnd);
+double stepScore(const GuidedCandidate& c, SeqPos lastAxisEnd, const GuidedConstraints& cfg) {
+  const SeqPos progressBp = std::max<SeqPos>(0, c.axisEnd - lastAxisEnd);
+  const SeqPos jumpBp = std::max<SeqPos>(0, c.axisStart - lastAxisEnd);
   const double progress = clamp01(static_cast<double>(progressBp) / 300000.0);
   const double jumpPenalty = clamp01(static_cast<double>(jumpBp) / std::max(1.0, static_cast<double>(cfg.maxJumpBp)));
   const double support = clamp01(static_cast<double>(c.supportCount) / 4.0);
-  const double len = clamp01(static_cast<double>(std::max(0, c.axisEnd - c.axisStart)) / 200000.0);
+  const double len = clamp01(static_cast<double>(std::max<SeqPos>(0, c.axisEnd - c.axisStart)) / 200000.0);
   return 0.40 * progress + 0.25 * support + 0.20 * len + 0.15 * (1.0 - jumpPenalty);
 }
 
@@ -298,11 +298,11 @@ GuidedStepResult GuidedStitchService::nextCandidates(const GuidedStepRequest& re
     if (c.axisStart < request.lastAxisEnd) {
       continue;  // strict monotonic progression
     }
-    const int jumpBp = c.axisStart - request.lastAxisEnd;
+    const SeqPos jumpBp = c.axisStart - request.lastAxisEnd;
     if (jumpBp > request.constraints.maxJumpBp) {
       continue;
     }
-    const int progressBp = c.axisEnd - request.lastAxisEnd;
+    const SeqPos progressBp = c.axisEnd - request.lastAxisEnd;
     if (progressBp < request.constraints.minProgressBp) {
       continue;
     }
@@ -25,9 +25,9 @@ std::string getTagValue(const AlignmentRecord& rec, const std::string& tag) {
   return {};
 }
 
-std::vector<std::pair<int, char>> parseCigar(const std::string& cigar) {
-  std::vector<std::pair<int, char>> ops;
-  int num = 0;
+std::vector<std::pair<SeqPos, char>> parseCigar(const std::string& cigar) {
+  std::vector<std::pair<SeqPos, char>> ops;
+  SeqPos num = 0;
   bool hasNum = false;
   for (char ch : cigar) {
     if (std::isdigit(static_cast<unsigned char>(ch))) {
@@ -46,7 +46,7 @@ std::vector<std::pair<int, char>> parseCigar(const std::string& cigar) {
 
 }  // namespace
 
-MappingResult mapQueryToTargetDetail(const AlignmentRecord& rec, int qPos) {
+MappingResult mapQueryToTargetDetail(const AlignmentRecord& rec, SeqPos qPos) {
   MappingResult result;
   result.reason = "no_mapping";
   result.qPos = qPos;
@@ -66,14 +66,14 @@ MappingResult mapQueryToTargetDetail(const AlignmentRecord& rec, int qPos) {
     return result;
   }
 
-  int qPosOriented = qPos;
-  int qCursor = rec.qStart;
+  SeqPos qPosOriented = qPos;
+  SeqPos qCursor = rec.qStart;
   if (rec.strand == '-') {
     qPosOriented = rec.qLen - 1 - qPos;
     qCursor = rec.qLen - rec.qEnd;
   }
   result.qPosOriented = qPosOriented;
-  int tCursor = rec.tStart;
+  SeqPos tCursor = rec.tStart;
 
   const auto ops = parseCigar(cigar);
   for (const auto& [len, op] : ops) {
@@ -0,0 +1,163 @@
+#include "gapneedle/motif_scanner.hpp"
+
+#include "gapneedle/fasta_io.hpp"
+#include "gapneedle/seq_kernels.hpp"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+
+namespace gapneedle {
+
+namespace {
+
+constexpr int kAlphabet = 4;
+constexpr std::uint8_t kOther = 4;
+
+// A/C/G/T (either case) to 0..3; anything else resets the automaton.
+const std::array<std::uint8_t, 256>& baseCodes() {
+  static const std::array<std::uint8_t, 256> codes = [] {
+    std::array<std::uint8_t, 256> t{};
+    t.fill(kOther);
+    t['A'] = t['a'] = 0;
+    t['C'] = t['c'] = 1;
+    t['G'] = t['g'] = 2;
+    t['T'] = t['t'] = 3;
+    return t;
+  }();
+  return codes;
+}
+
+}  // namespace
+
+MotifScanner::MotifScanner(const std::vector<std::string>& motifs, bool bothStrands) {
+  const auto& codes = baseCodes();
+  std::vector<std::string> strands;  // parallel to patterns_
+  for (std::string motif : motifs) {
+    if (motif.empty()) {
+      throw std::runtime_error("Motif must not be empty");
+    }
+    toUpperInPlace(motif.data(), motif.size());
+    if (std::find(strands.begin(), strands.end(), motif) != strands.end() ||
+        std::find(motifs_.begin(), motifs_.end(), motif) != motifs_.end()) {
+      continue;
+    }
+    // Other bases never match in the text, so such a motif is reported with no copies.
+    if (std::any_of(motif.begin(), motif.end(), [&codes](char ch) { return codes[static_cast<unsigned char>(ch)] == kOther; })) {
+      motifs_.push_back(motif);
+      continue;
+    }
+    const auto id = static_cast<std::uint32_t>(motifs_.size());
+    motifs_.push_back(motif);
+    strands.push_back(motif);
+    patterns_.push_back({id, static_cast<std::uint32_t>(motif.size())});
+    if (bothStrands) {
+      std::string rc = reverseComplement(motif);
+      if (rc != motif) {
+        strands.push_back(std::move(rc));
+        patterns_.push_back({id, static_cast<std::uint32_t>(motif.size())});
+      }
+    }
+  }
+
+  // Trie of every strand sequence, then failure links by BFS, folded into a complete DFA.
+  next_.assign(kAlphabet, -1);
+  std::vector<std::vector<std::uint32_t>> out(1);
+  for (std::uint32_t p = 0; p < strands.size(); ++p) {
+    std::int32_t state = 0;
+    for (char ch : strands[p]) {
+      const std::size_t slot = static_cast<std::size_t>(state) * kAlphabet + codes[static_cast<unsigned char>(ch)];
+      if (next_[slot] < 0) {
+        next_[slot] = static_cast<std::int32_t>(out.size());
+        next_.resize(next_.size() + kAlphabet, -1);
+        out.emplace_back();
+      }
+      state = next_[slot];
+    }
+    out[static_cast<std::size_t>(state)].push_back(p);
+  }
+
+  std::vector<std::int32_t> fail(out.size(), 0);
+  std::deque<std::int32_t> queue;
+  for (int c = 0; c < kAlphabet; ++c) {
+    std::int32_t& child = next_[static_cast<std::size_t>(c)];
+    if (child < 0) {
+      child = 0;
+    } else {
+      queue.push_back(child);
+    }
+  }
+  while (!queue.empty()) {
+    const std::int32_t state = queue.front();
+    queue.pop_front();
+    const auto& inherited = out[static_cast<std::size_t>(fail[static_cast<std::size_t>(state)])];
+    auto& own = out[static_cast<std::size_t>(state)];
+    own.insert(own.end(), inherited.begin(), inherited.end());
+    for (int c = 0; c < kAlphabet; ++c) {
+      const std::size_t slot = static_cast<std::size_t>(state) * kAlphabet + static_cast<std::size_t>(c);
+      const std::int32_t viaFail = next_[static_cast<std::size_t>(fail[static_cast<std::size_t>(state)]) * kAlphabet +
+                                         static_cast<std::size_t>(c)];
+      if (next_[slot] < 0) {
+        next_[slot] = viaFail;
+      } else {
+        fail[static_cast<std::size_t>(next_[slot])] = viaFail;
+        queue.push_back(next_[slot]);
+      }
+    }
+  }
+
+  outputBegin_.reserve(out.size() + 1);
+  for (auto& ids : out) {
+    std::stable_sort(ids.begin(), ids.end(), [this](std::uint32_t a, std::uint32_t b) {
+      return patterns_[a].length > patterns_[b].length;
+    });
+    outputBegin_.push_back(static_cast<std::uint32_t>(outputs_.size()));
+    outputs_.insert(outputs_.end(), ids.begin(), ids.end());
+  }
+  outputBegin_.push_back(static_cast<std::uint32_t>(outputs_.size()));
+}
+
+std::vector<MotifRunStats> MotifScanner::scan(std::string_view seq, const CopyCallback& onCopy) const {
+  std::vector<MotifRunStats> stats(motifs_.size());
+  if (patterns_.empty()) {
+    return stats;
+  }
+  // Per pattern: end of the last counted copy (the next copy must start at or after it) and the
+  // length of the run that copy belongs to.
+  std::vector<SeqPos> lastEnd(patterns_.size(), std::numeric_limits<SeqPos>::min());
+  std::vector<SeqPos> run(patterns_.size(), 0);
+  const auto& codes = baseCodes();
+  const std::int32_t* next = next_.data();
+  std::int32_t state = 0;
+  for (std::size_t i = 0; i < seq.size(); ++i) {
+    const std::uint8_t c = codes[static_cast<unsigned char>(seq[i])];
+    if (c == kOther) {
+      state = 0;
+      continue;
+    }
+    state = next[static_cast<std::size_t>(state) * kAlphabet + c];
+    const std::uint32_t begin = outputBegin_[static_cast<std::size_t>(state)];
+    const std::uint32_t end = outputBegin_[static_cast<std::size_t>(state) + 1];
+    for (std::uint32_t k = begin; k < end; ++k) {
+      const std::uint32_t p = outputs_[k];
+      const SeqPos copyEnd = static_cast<SeqPos>(i) + 1;
+      const SeqPos copyStart = copyEnd - patterns_[p].length;
+      if (copyStart < lastEnd[p]) {
+        continue;  // overlaps the previous copy of this strand
+      }
+      run[p] = copyStart == lastEnd[p] ? run[p] + 1 : 1;
+      lastEnd[p] = copyEnd;
+      MotifRunStats& s = stats[patterns_[p].motif];
+      ++s.copies;
+      s.longestRun = std::max(s.longestRun, run[p]);
+      if (onCopy) {
+        onCopy(copyStart, copyEnd);
+      }
+    }
+  }
+  return stats;
+}
+
+}  // namespace gapneedle
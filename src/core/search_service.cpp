@@ -0,0 +1,363 @@
+#include "gapneedle/search_service.hpp"
+
+#include "gapneedle/edit_matcher.hpp"
+#include "gapneedle/fasta_io.hpp"
+#include "gapneedle/fm_index.hpp"
+#include "gapneedle/seq_kernels.hpp"
+#include "util/parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+
+namespace gapneedle {
+
+namespace {
+
+// Match starts handled by one task; each worker buffers this many bases plus the query overlap.
+constexpr SeqPos kSearchChunkBases = SeqPos{8} << 20;
+// Indexed searches with more hits than this are streamed from a scan instead of located all at once.
+constexpr SeqPos kMaxIndexedHits = SeqPos{1} << 22;
+// Shortest exact piece worth seeding approximate matches with; shorter ones match too often to
+// beat aligning everywhere.
+constexpr std::size_t kMinSeedBases = 12;
+
+// Chunk buffer of the thread running a search task, reused across that search's chunks (a fresh
+// 8 MB buffer per task costs page faults). parallelFor's workers exit with theirs; the calling
+// thread releases its own when the search ends.
+std::string& chunkBuffer() {
+  thread_local std::string buf;
+  return buf;
+}
+
+struct SearchTask {
+  std::size_t seq;
+  SeqPos start;  // match starts in [start, end)
+  SeqPos end;
+};
+
+void searchChunk(const FastaIndexedReader& reader,
+                 const std::string& name,
+                 SeqPos len,
+                 const SearchTask& task,
+                 const std::string& fwd,
+                 const std::string& rc,
+                 std::string& buf,
+                 std::vector<SearchHit>& hits) {
+  const std::size_t q = fwd.size();
+  const SeqPos readEnd = std::min(len, task.end + static_cast<SeqPos>(q) - 1);
+  buf.resize(static_cast<std::size_t>(readEnd - task.start));
+  const std::size_t got = reader.fetchInto(name, task.start, readEnd, buf.data());
+  if (got < q) {
+    return;
+  }
+  const std::size_t candidates = std::min(static_cast<std::size_t>(task.end - task.start), got - q + 1);
+  const std::string& other = rc.empty() ? fwd : rc;
+  std::size_t i = 0;
+  while (true) {
+    i += findPatternPair(buf.data() + i, candidates - i, fwd.data(), other.data(), q);
+    if (i >= candidates) {
+      break;
+    }
+    const char* p = buf.data() + i;
+    const SeqPos start = task.start + static_cast<SeqPos>(i);
+    if (std::memcmp(p, fwd.data(), q) == 0) {
+      hits.push_back(SearchHit{name, start, start + static_cast<SeqPos>(q), false});
+    }
+    if (!rc.empty() && std::memcmp(p, rc.data(), q) == 0) {
+      hits.push_back(SearchHit{name, start, start + static_cast<SeqPos>(q), true});
+    }
+    ++i;
+  }
+}
+
+// One of the maxEdits + 1 pieces of the query, and its reverse complement (a piece of the
+// reverse-complemented query).
+struct SeedPiece {
+  std::string fwd;
+  std::string rc;
+  std::size_t offset;  // in the query
+};
+
+struct ApproxPlan {
+  std::unique_ptr<EditMatcher> fwd;
+  std::unique_ptr<EditMatcher> rc;  // null when searching one strand
+  std::vector<SeedPiece> pieces;    // empty: align the whole chunk
+};
+
+// Ends whose hits belong to the chunk: [task.start + 1, task.end] (the last base is in the task).
+void searchChunkApprox(const FastaIndexedReader& reader,
+                       const std::string& name,
+                       SeqPos len,
+                       const SearchTask& task,
+                       const ApproxPlan& plan,
+                       std::string& buf,
+                       std::vector<SearchHit>& hits) {
+  const std::size_t m = plan.fwd->patternLength();
+  const std::size_t k = plan.fwd->maxEdits();
+  // Enough bases before the first end for exact distances there and at the end before it.
+  const auto reach = static_cast<SeqPos>(m + k + 1);
+  const SeqPos readStart = task.start > reach ? task.start - reach : 0;
+  const SeqPos readEnd = std::min(len, task.end + 1);
+  buf.resize(static_cast<std::size_t>(readEnd - readStart));
+  const std::size_t got = reader.fetchInto(name, readStart, readEnd, buf.data());
+  buf.resize(got);
+  const auto from = static_cast<std::size_t>(task.start + 1 - readStart);
+  const std::size_t to = std::min(got, static_cast<std::size_t>(task.end - readStart));
+  if (got < m - k || from > to) {
+    return;
+  }
+
+  std::vector<std::tuple<SeqPos, bool, SeqPos, unsigned>> found;  // end, reverse, start, edits
+  auto align = [&](const EditMatcher& matcher, bool reverse, std::size_t lo, std::size_t hi) {
+    const std::size_t scanStart = lo > m + k + 1 ? lo - (m + k + 1) : 0;
+    matcher.scan(buf.data() + scanStart, got - scanStart, lo - scanStart, hi - scanStart,
+                 [&](std::size_t end, unsigned edits) {
+                   const std::size_t e = scanStart + end;
+                   const std::size_t s = matcher.alignStart(buf.data(), e);
+                   found.emplace_back(readStart + static_cast<SeqPos>(e), reverse, readStart + static_cast<SeqPos>(s), edits);
+                 });
+  };
+
+  if (plan.pieces.empty()) {
+    align(*plan.fwd, false, from, to);
+    if (plan.rc) align(*plan.rc, true, from, to);
+  } else {
+    // Every occurrence holds some piece unchanged, so its end lies within k of where the piece
+    // puts the end of an exact match.
+    std::vector<std::pair<std::size_t, std::size_t>> windows[2];
+    for (const auto& piece : plan.pieces) {
+      const std::size_t l = piece.fwd.size();
+      if (got < l) continue;
+      const std::size_t candidates = got - l + 1;
+      const std::size_t rcOffset = m - piece.offset - l;
+      for (std::size_t i = 0;; ++i) {
+        i += findPatternPair(buf.data() + i, candidates - i, piece.fwd.data(), piece.rc.data(), l);
+        if (i >= candidates) break;
+        const char* p = buf.data() + i;
+        for (const bool reverse : {false, true}) {
+          if ((reverse && !plan.rc) || std::memcmp(p, reverse ? piece.rc.data() : piece.fwd.data(), l) != 0) {
+            continue;
+          }
+          const std::size_t matchEnd = i + m - (reverse ? rcOffset : piece.offset);
+          const std::size_t lo = std::max(from, matchEnd > k ? matchEnd - k : 0);
+          const std::size_t hi = std::min(to, matchEnd + k);
+          if (lo <= hi) windows[reverse].emplace_back(lo, hi);
+        }
+      }
+    }
+    for (const bool reverse : {false, true}) {
+      auto& w = windows[reverse];
+      std::sort(w.begin(), w.end());
+      for (std::size_t a = 0; a < w.size();) {
+        std::size_t hi = w[a].second;
+        std::size_t b = a + 1;
+        // Restarting costs m + k columns, so nearby windows are aligned in one run.
+        for (; b < w.size() && w[b].first <= hi + m + k + 1; ++b) hi = std::max(hi, w[b].second);
+        align(reverse ? *plan.rc : *plan.fwd, reverse, w[a].first, hi);
+        a = b;
+      }
+    }
+  }
+
+  std::sort(found.begin(), found.end());
+  for (const auto& [end, reverse, start, edits] : found) {
+    hits.push_back(SearchHit{name, start, end, reverse, edits});
+  }
+}
+
+bool isCancelled(const SearchOptions& options) {
+  return options.cancel != nullptr && options.cancel->load(std::memory_order_relaxed);
+}
+
+// Answers the search from the cached FM-index; false when the hit count is better served by the
+// scan, which stops early at maxHits and holds one chunk of hits at a time.
+bool searchIndexed(const std::string& fastaPath,
+                   const std::string& fwd,
+                   const std::string& rc,
+                   const SearchOptions& options,
+                   const SearchSink& sink) {
+  const auto index = acquireFmIndex(fastaPath, options.indexCacheDir, options.cancel);
+  const SeqPos total = index->count(fwd) + (rc.empty() ? 0 : index->count(rc));
+  const SeqPos limit = options.maxHits == 0 ? kMaxIndexedHits
+                                            : std::max(kMaxIndexedHits, static_cast<SeqPos>(options.maxHits));
+  if (total > limit) {
+    return false;
+  }
+  std::vector<SearchHit> hits = index->locate(fwd, !rc.empty());
+  if (options.maxHits != 0 && hits.size() > options.maxHits) {
+    hits.resize(options.maxHits);
+  }
+  const std::size_t batchHits = std::max<std::size_t>(options.batchHits, 1);
+  std::vector<SearchHit> batch;
+  for (std::size_t i = 0; i < hits.size() && !isCancelled(options); i += batchHits) {
+    batch.assign(std::make_move_iterator(hits.begin() + static_cast<std::ptrdiff_t>(i)),
+                 std::make_move_iterator(hits.begin() + static_cast<std::ptrdiff_t>(std::min(hits.size(), i + batchHits))));
+    if (!sink(batch)) {
+      break;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+void searchFasta(const std::string& fastaPath,
+                 const std::string& query,
+                 const SearchOptions& options,
+                 const SearchSink& sink) {
+  std::string fwd = query;
+  toUpperInPlace(fwd.data(), fwd.size());
+  if (fwd.empty()) {
+    throw std::runtime_error("Search query must not be empty");
+  }
+  std::string rc;
+  if (options.bothStrands) {
+    rc = reverseComplement(fwd);
+    if (rc == fwd) {
+      rc.clear();
+    }
+  }
+
+  if (options.maxEdits == 0 && options.useIndex && FmIndex::supports(fwd) &&
+      searchIndexed(fastaPath, fwd, rc, options, sink)) {
+    return;
+  }
+
+  ApproxPlan approx;
+  if (options.maxEdits > 0) {
+    approx.fwd = std::make_unique<EditMatcher>(fwd, options.maxEdits);
+    if (!rc.empty()) {
+      approx.rc = std::make_unique<EditMatcher>(rc, options.maxEdits);
+    }
+    // Query bases other than ACGT never match, so only an ACGT query is sure to keep a piece intact.
+    const std::size_t pieces = options.maxEdits + 1;
+    if (fwd.size() / pieces >= kMinSeedBases && fwd.find_first_not_of("ACGT") == std::string::npos) {
+      for (std::size_t i = 0; i < pieces; ++i) {
+        const std::size_t offset = i * (fwd.size() / pieces);
+        const std::size_t l = i + 1 == pieces ? fwd.size() - offset : fwd.size() / pieces;
+        std::string piece = fwd.substr(offset, l);
+        std::string pieceRc = reverseComplement(piece);
+        approx.pieces.push_back(SeedPiece{std::move(piece), std::move(pieceRc), offset});
+      }
+    }
+  }
+
+  // Positioned reads like scanGaps: a mapped scan would leave the whole genome resident.
+  FastaReaderOptions readerOptions;
+  readerOptions.useMmap = false;
+  readerOptions.blockCacheBytes = 0;
+  const FastaIndexedReader reader(fastaPath, readerOptions);
+  const std::vector<std::string> names = reader.listNames();
+  std::vector<SeqPos> lengths(names.size());
+  std::vector<SearchTask> tasks;
+  for (std::size_t s = 0; s < names.size(); ++s) {
+    lengths[s] = reader.length(names[s]);
+    for (SeqPos start = 0; start < lengths[s]; start += kSearchChunkBases) {
+      tasks.push_back(SearchTask{s, start, std::min(lengths[s], start + kSearchChunkBases)});
+    }
+  }
+
+  // Finished chunks wait here until every earlier chunk has been handed to the sink.
+  std::mutex mu;
+  std::vector<std::vector<SearchHit>> pending(tasks.size());
+  std::vector<char> done(tasks.size(), 0);
+  std::size_t nextToEmit = 0;
+  std::size_t emitted = 0;
+  std::atomic<bool> stop{false};
+  const std::size_t batchHits = std::max<std::size_t>(options.batchHits, 1);
+  std::vector<SearchHit> batch;
+
+  auto flush = [&]() {
+    if (!batch.empty() && !stop) {
+      if (!sink(batch)) {
+        stop = true;
+      }
+    }
+    batch.clear();
+  };
+
+  parallelFor(tasks.size(), options.threads, [&](std::size_t t) {
+    if (stop || isCancelled(options)) {
+      stop = true;
+      return;
+    }
+    std::vector<SearchHit> hits;
+    std::string& buf = chunkBuffer();
+    const SearchTask& task = tasks[t];
+    if (approx.fwd) {
+      searchChunkApprox(reader, names[task.seq], lengths[task.seq], task, approx, buf, hits);
+    } else {
+      searchChunk(reader, names[task.seq], lengths[task.seq], task, fwd, rc, buf, hits);
+    }
+
+    std::lock_guard<std::mutex> lock(mu);
+    pending[t] = std::move(hits);
+    done[t] = 1;
+    while (nextToEmit < tasks.size() && done[nextToEmit] && !stop) {
+      for (auto& hit : pending[nextToEmit]) {
+        if (stop) {
+          break;
+        }
+        batch.push_back(std::move(hit));
+        ++emitted;
+        if (options.maxHits != 0 && emitted >= options.maxHits) {
+          flush();
+          stop = true;
+        }
+        if (batch.size() >= batchHits) {
+          flush();
+        }
+      }
+      std::vector<SearchHit>().swap(pending[nextToEmit]);
+      ++nextToEmit;
+    }
+    flush();
+  });
+  std::string().swap(chunkBuffer());
+}
+
+std::vector<SearchHit> searchFasta(const std::string& fastaPath,
+                                   const std::string& query,
+                                   const SearchOptions& options) {
+  std::vector<SearchHit> all;
+  searchFasta(fastaPath, query, options, [&all](const std::vector<SearchHit>& batch) {
+    all.insert(all.end(), batch.begin(), batch.end());
+    return true;
+  });
+  return all;
+}
+
+std::size_t countFastaHits(const std::string& fastaPath, const std::string& query, const SearchOptions& options) {
+  std::string fwd = query;
+  toUpperInPlace(fwd.data(), fwd.size());
+  if (options.maxEdits == 0 && options.useIndex && FmIndex::supports(fwd)) {
+    const std::string rc = options.bothStrands ? reverseComplement(fwd) : std::string();
+    const auto index = acquireFmIndex(fastaPath, options.indexCacheDir, options.cancel);
+    const auto total = static_cast<std::size_t>(index->count(fwd) + (rc.empty() || rc == fwd ? 0 : index->count(rc)));
+    return options.maxHits == 0 ? total : std::min(total, options.maxHits);
+  }
+  std::size_t total = 0;
+  searchFasta(fastaPath, query, options, [&total](const std::vector<SearchHit>& batch) {
+    total += batch.size();
+    return true;
+  });
+  return total;
+}
+
+void writeSearchHits(std::ostream& out, const std::vector<SearchHit>& hits, bool withEdits) {
+  for (const auto& h : hits) {
+    out << h.seqName << '\t' << h.start << '\t' << h.end << '\t' << (h.reverse ? '-' : '+');
+    if (withEdits) {
+      out << '\t' << h.edits;
+    }
+    out << '\n';
+  }
+}
+
+}  // namespace gapneedle
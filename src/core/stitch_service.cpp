@@ -60,18 +60,18 @@ StitchResult StitchService::stitch(const StitchRequest& request) const {
     throw std::runtime_error("outputFastaPath is required");
   }
 
-  const auto target = readFasta(request.targetFasta);
-  const auto query = readFasta(request.queryFasta);
+  const auto target = readFastaPacked(request.targetFasta);
+  const auto query = readFastaPacked(request.queryFasta);
 
-  std::unordered_map<std::string, FastaMap> extras;
+  std::unordered_map<std::string, PackedFastaMap> extras;
   for (const auto& [src, path] : request.extraFastaBySource) {
-    extras[src] = readFasta(path);
+    extras[src] = readFastaPacked(path);
   }
 
   std::vector<std::string> pieceSeqs;
   pieceSeqs.reserve(request.segments.size());
   for (const auto& seg : request.segments) {
-    const FastaMap* sourceMap = nullptr;
+    const PackedFastaMap* sourceMap = nullptr;
     if (seg.source == "t") {
       sourceMap = &target;
     } else if (seg.source == "q") {
@@ -88,28 +88,37 @@ StitchResult StitchService::stitch(const StitchRequest& request) const {
     if (sit == sourceMap->end()) {
       throw std::runtime_error("Sequence not found: " + seg.seqName + " from source " + seg.source);
     }
-    std::string seq = sit->second;
-    if (seg.reverse) {
-      seq = reverseComplement(seq);
-    }
-    if (seg.start < 0 || seg.end <= seg.start || seg.end > static_cast<int>(seq.size())) {
+    const PackedSequence& seq = sit->second;
+    const SeqPos len = static_cast<SeqPos>(seq.size());
+    if (seg.start < 0 || seg.end <= seg.start || seg.end > len) {
       throw std::runtime_error("Invalid segment range for " + seg.seqName);
     }
-    pieceSeqs.push_back(seq.substr(seg.start, seg.end - seg.start));
+    if (seg.reverse) {
+      // [start, end) on the reverse-complemented contig is [len - end, len - start) on the
+      // forward strand, so only the slice itself is decoded and complemented.
+      pieceSeqs.push_back(reverseComplement(seq.decode(static_cast<std::size_t>(len - seg.end),
+                                                       static_cast<std::size_t>(len - seg.start))));
+    } else {
+      pieceSeqs.push_back(seq.decode(static_cast<std::size_t>(seg.start), static_cast<std::size_t>(seg.end)));
+    }
   }
 
-  std::string merged;
+  // Pieces are streamed into the output as-is; the merged sequence is never materialised.
+  FastaWriterOptions writerOptions;
+  writerOptions.writeFai = true;
+  FastaWriter out(request.outputFastaPath, writerOptions);
+  out.beginRecord(request.outputSeqName.empty() ? "stitched" : request.outputSeqName);
+  std::size_t mergedLength = 0;
   for (const auto& p : pieceSeqs) {
-    merged += p;
+    out.append(p);
+    mergedLength += p.size();
   }
-
-  FastaMap out{{request.outputSeqName.empty() ? "stitched" : request.outputSeqName, merged}};
-  writeFasta(request.outputFastaPath, out);
+  out.commit();
 
   StitchResult result;
   result.outputFastaPath = request.outputFastaPath;
   result.outputLogPath = request.outputFastaPath + ".session.json";
-  result.mergedLength = merged.size();
+  result.mergedLength = mergedLength;
 
   for (std::size_t i = 0; i + 1 < pieceSeqs.size(); ++i) {
     BreakpointSummary s;
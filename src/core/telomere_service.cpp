@@ -1,59 +1,175 @@
 #include "gapneedle/telomere_service.hpp"
 
 #include "gapneedle/fasta_io.hpp"
+#include "util/parallel.hpp"
 
+#include <algorithm>
+#include <iomanip>
 #include <stdexcept>
 
 namespace gapneedle {
 
 namespace {
 
-bool hasConsecutiveMotif(const std::string& seq, const std::string& motif, int minRepeats) {
-  if (motif.empty() || minRepeats <= 0) {
-    return false;
-  }
-  int count = 0;
-  std::size_t pos = 0;
-  while (pos + motif.size() <= seq.size()) {
-    if (seq.compare(pos, motif.size(), motif) == 0) {
-      ++count;
-      if (count >= minRepeats) {
-        return true;
+TelomereEndReport analyzeEnd(const MotifScanner& scanner,
+                             const std::string& seq,
+                             int minRepeats,
+                             SeqPos binBases,
+                             bool fromEnd) {
+  TelomereEndReport report;
+  report.windowBases = static_cast<SeqPos>(seq.size());
+  std::vector<SeqPos> covered;
+  MotifScanner::CopyCallback onCopy;
+  std::vector<bool> seen;
+  if (binBases > 0) {
+    covered.assign(static_cast<std::size_t>((report.windowBases + binBases - 1) / binBases), 0);
+    // Copies of different motifs may overlap or nest in any order, so each base is marked once.
+    seen.assign(seq.size(), false);
+    onCopy = [&](SeqPos copyStart, SeqPos copyEnd) {
+      for (SeqPos k = copyStart; k < copyEnd; ++k) {
+        if (seen[static_cast<std::size_t>(k)]) {
+          continue;
+        }
+        seen[static_cast<std::size_t>(k)] = true;
+        const SeqPos oriented = fromEnd ? report.windowBases - 1 - k : k;
+        ++covered[static_cast<std::size_t>(oriented / binBases)];
       }
-      pos += motif.size();
-    } else {
-      count = 0;
-      ++pos;
+    };
+  }
+  report.motifs = scanner.scan(seq, onCopy);
+  for (const auto& m : report.motifs) {
+    report.repeatCount += m.copies;
+    report.longestRun = std::max(report.longestRun, m.longestRun);
+  }
+  report.hasTelomere = minRepeats > 0 && report.longestRun >= minRepeats;
+  report.density.reserve(covered.size());
+  for (std::size_t b = 0; b < covered.size(); ++b) {
+    const SeqPos binStart = static_cast<SeqPos>(b) * binBases;
+    const SeqPos binLen = std::min(binBases, report.windowBases - binStart);
+    report.density.push_back(static_cast<double>(covered[b]) / static_cast<double>(binLen));
+  }
+  return report;
+}
+
+// Reads the two end windows of `seqName` (one coalesced read when they are close) and analyses
+// them; the sequence itself is never loaded.
+TelomereReport analyzeSequence(const FastaIndexedReader& reader,
+                               const std::string& seqName,
+                               const MotifScanner& scanner,
+                               const TelomereScanOptions& options) {
+  const SeqPos len = reader.length(seqName);
+  if (len < 0) {
+    throw std::runtime_error("Sequence not found: " + seqName);
+  }
+  const SeqPos w = std::clamp<SeqPos>(options.window, 0, len);
+  const auto ends = reader.fetchMany({{seqName, 0, w, false}, {seqName, len - w, len, false}});
+
+  TelomereReport report;
+  report.seqName = seqName;
+  report.length = len;
+  report.motifs = scanner.motifs();
+  report.left = analyzeEnd(scanner, ends[0], options.minRepeats, options.binBases, false);
+  report.right = analyzeEnd(scanner, ends[1], options.minRepeats, options.binBases, true);
+  return report;
+}
+
+std::string jsonEscape(const std::string& raw) {
+  std::string out;
+  out.reserve(raw.size() + 2);
+  for (char ch : raw) {
+    switch (ch) {
+      case '\\': out += "\\\\"; break;
+      case '"': out += "\\\""; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default: out += ch; break;
     }
   }
-  return false;
+  return out;
+}
+
+void writeDensity(std::ostream& out, const std::vector<double>& density, char sep) {
+  for (std::size_t i = 0; i < density.size(); ++i) {
+    if (i > 0) out << sep;
+    out << density[i];
+  }
+}
+
+void writeEndJson(std::ostream& out, const std::vector<std::string>& motifs, const TelomereEndReport& end) {
+  out << "{\"window\":" << end.windowBases << ",\"repeats\":" << end.repeatCount
+      << ",\"longest_run\":" << end.longestRun << ",\"telomere\":" << (end.hasTelomere ? "true" : "false")
+      << ",\"density\":[";
+  writeDensity(out, end.density, ',');
+  out << "],\"motifs\":[";
+  for (std::size_t i = 0; i < end.motifs.size(); ++i) {
+    out << (i > 0 ? "," : "") << "{\"motif\":\"" << motifs[i] << "\",\"repeats\":" << end.motifs[i].copies
+        << ",\"longest_run\":" << end.motifs[i].longestRun << '}';
+  }
+  out << "]}";
 }
 
 }  // namespace
 
 std::pair<bool, bool> checkTelomere(const std::string& fastaPath,
                                     const std::string& seqName,
-                                    int window,
+                                    SeqPos window,
                                     const std::string& motif,
                                     int minRepeats) {
-  const auto seqs = readFastaSelected(fastaPath, {seqName});
-  auto it = seqs.find(seqName);
-  if (it == seqs.end()) {
-    throw std::runtime_error("Sequence not found: " + seqName);
-  }
-  const std::string& seq = it->second;
-  const int w = std::min<int>(window, static_cast<int>(seq.size()));
-  const std::string left = seq.substr(0, w);
-  const std::string right = seq.substr(seq.size() - w);
+  TelomereScanOptions options;
+  options.window = window;
+  options.minRepeats = minRepeats;
+  options.binBases = 0;
+  const MotifScanner scanner({motif});
+  const auto report = analyzeSequence(*acquireFastaReader(fastaPath), seqName, scanner, options);
+  return {report.left.hasTelomere, report.right.hasTelomere};
+}
 
-  const std::string motifUpper = motif;
-  const std::string rc = reverseComplement(motifUpper);
+std::vector<TelomereReport> scanTelomeres(const std::string& fastaPath, const TelomereScanOptions& options) {
+  const MotifScanner scanner(options.motifs);
+  const auto reader = acquireFastaReader(fastaPath);
+  const std::vector<std::string> names = reader->listNames();
+  std::vector<TelomereReport> reports(names.size());
+  parallelFor(names.size(), options.threads, [&](std::size_t i) {
+    reports[i] = analyzeSequence(*reader, names[i], scanner, options);
+  });
+  return reports;
+}
 
-  const bool leftHas = hasConsecutiveMotif(left, motifUpper, minRepeats) ||
-                       hasConsecutiveMotif(left, rc, minRepeats);
-  const bool rightHas = hasConsecutiveMotif(right, motifUpper, minRepeats) ||
-                        hasConsecutiveMotif(right, rc, minRepeats);
-  return {leftHas, rightHas};
+void writeTelomereTsv(std::ostream& out, const std::vector<TelomereReport>& reports) {
+  const auto flags = out.flags();
+  out << std::fixed << std::setprecision(4);
+  out << "seq\tlength\tend\twindow\trepeats\tlongest_run\ttelomere\tdensity\tmotifs\n";
+  for (const auto& r : reports) {
+    for (const auto* end : {&r.left, &r.right}) {
+      out << r.seqName << '\t' << r.length << '\t' << (end == &r.left ? "left" : "right") << '\t'
+          << end->windowBases << '\t' << end->repeatCount << '\t' << end->longestRun << '\t'
+          << (end->hasTelomere ? "yes" : "no") << '\t';
+      writeDensity(out, end->density, ',');
+      out << '\t';
+      for (std::size_t i = 0; i < end->motifs.size(); ++i) {
+        out << (i > 0 ? "," : "") << r.motifs[i] << ':' << end->motifs[i].copies << ':' << end->motifs[i].longestRun;
+      }
+      out << '\n';
+    }
+  }
+  out.flags(flags);
+}
+
+void writeTelomereJson(std::ostream& out, const std::vector<TelomereReport>& reports) {
+  const auto flags = out.flags();
+  out << std::fixed << std::setprecision(4);
+  out << "[\n";
+  for (std::size_t i = 0; i < reports.size(); ++i) {
+    const auto& r = reports[i];
+    out << "  {\"name\":\"" << jsonEscape(r.seqName) << "\",\"length\":" << r.length << ",\"left\":";
+    writeEndJson(out, r.motifs, r.left);
+    out << ",\"right\":";
+    writeEndJson(out, r.motifs, r.right);
+    out << '}' << (i + 1 < reports.size() ? "," : "") << '\n';
+  }
+  out << "]\n";
+  out.flags(flags);
 }
 
 }  // namespace gapneedle
@@ -1,7 +1,7 @@
 #include "fasta_search_page.hpp"
 
-#include "gapneedle/fasta_io.hpp"
-
+#include <QCheckBox>
+#include <QCoreApplication>
 #include <QFileDialog>
 #include <QFormLayout>
 #include <QHeaderView>
@@ -10,10 +10,22 @@
 #include <QLineEdit>
 #include <QMessageBox>
 #include <QPushButton>
+#include <QSpinBox>
 #include <QTableWidget>
 #include <QVBoxLayout>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+
+namespace {
+
+// Rows kept in the table; the search stops once one more hit than this has been found.
+constexpr qulonglong kMaxShownHits = 100000;
 
-FastaSearchPage::FastaSearchPage(QWidget* parent) : QWidget(parent) {
+}  // namespace
+
+FastaSearchPage::FastaSearchPage(gapneedle::GapNeedleFacade* facade, QWidget* parent)
+    : QWidget(parent), facade_(facade) {
   auto* layout = new QVBoxLayout(this);
   layout->setContentsMargins(12, 12, 12, 12);
   layout->setSpacing(8);
@@ -30,66 +42,153 @@ FastaSearchPage::FastaSearchPage(QWidget* parent) : QWidget(parent) {
 
   query_ = new QLineEdit(this);
   query_->setPlaceholderText("ACGT...");
+  bothStrands_ = new QCheckBox("Also search reverse complement", this);
+  bothStrands_->setChecked(true);
+  useIndex_ = new QCheckBox("Use cached FM-index (built on first search)", this);
+  useIndex_->setToolTip("Keeps an index of the FASTA next to the minimap2 index cache so repeated "
+                        "searches answer without rescanning. Only exact ACGT queries use it.");
   form->addRow("FASTA path", fastaRow);
   form->addRow("Query sequence", query_);
+  maxEdits_ = new QSpinBox(this);
+  maxEdits_->setRange(0, 32);
+  maxEdits_->setToolTip("Substitutions, insertions and deletions allowed per hit; 0 = exact match.");
+  form->addRow("", bothStrands_);
+  form->addRow("Max edits", maxEdits_);
+  form->addRow("", useIndex_);
 
-  auto* run = new QPushButton("Search", this);
-  run->setObjectName("primaryButton");
-  auto* summary = new QLabel("No search executed.", this);
-  summary->setObjectName("subtitleLabel");
+  runBtn_ = new QPushButton("Search", this);
+  runBtn_->setObjectName("primaryButton");
+  summary_ = new QLabel("No search executed.", this);
+  summary_->setObjectName("subtitleLabel");
 
   connect(browse, &QPushButton::clicked, this, [this]() {
     const QString p = QFileDialog::getOpenFileName(this,
                                                     "Select FASTA",
                                                     QString(),
-                                                    "FASTA (*.fa *.fasta *.fna);;All files (*)");
+                                                    "FASTA (*.fa *.fasta *.fna *.fa.gz *.gnseq);;All files (*)");
     if (!p.isEmpty()) {
       fastaPath_->setText(p);
     }
   });
-  connect(run, &QPushButton::clicked, this, &FastaSearchPage::onSearch);
+  connect(runBtn_, &QPushButton::clicked, this, &FastaSearchPage::onSearch);
 
   table_ = new QTableWidget(this);
-  table_->setColumnCount(3);
-  table_->setHorizontalHeaderLabels({"seq", "start", "end"});
+  table_->setColumnCount(5);
+  table_->setHorizontalHeaderLabels({"seq", "start", "end", "strand", "edits"});
   table_->setAlternatingRowColors(true);
   table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
   table_->horizontalHeader()->setStretchLastSection(true);
 
   layout->addLayout(form);
-  layout->addWidget(run);
-  layout->addWidget(summary);
+  layout->addWidget(runBtn_);
+  layout->addWidget(summary_);
   layout->addWidget(table_, 1);
 }
 
+FastaSearchPage::~FastaSearchPage() {
+  // The worker posts batches to this page, so it must be gone before the page is.
+  if (watcher_ != nullptr) {
+    cancel_->store(true);
+    watcher_->waitForFinished();
+  }
+}
+
 void FastaSearchPage::onSearch() {
-  table_->setRowCount(0);
-  const std::string q = query_->text().trimmed().toUpper().toStdString();
+  if (watcher_ != nullptr) {
+    cancel_->store(true);
+    runBtn_->setEnabled(false);
+    summary_->setText("Cancelling...");
+    return;
+  }
+
+  const std::string q = query_->text().simplified().remove(' ').toUpper().toStdString();
   if (q.empty()) {
     QMessageBox::information(this, "Empty query", "Please enter query sequence.");
     return;
   }
+  if (static_cast<std::size_t>(maxEdits_->value()) >= q.size()) {
+    QMessageBox::information(this, "Too many edits", "Max edits must be smaller than the query length.");
+    return;
+  }
 
-  try {
-    const auto fasta = gapneedle::readFasta(fastaPath_->text().toStdString());
-    int row = 0;
-    for (const auto& [name, seq] : fasta) {
-      std::size_t pos = 0;
-      while (true) {
-        pos = seq.find(q, pos);
-        if (pos == std::string::npos) {
-          break;
+  table_->setRowCount(0);
+  hitCount_ = 0;
+  cancel_ = std::make_shared<std::atomic<bool>>(false);
+  runBtn_->setText("Cancel");
+  summary_->setText("Searching...");
+
+  gapneedle::SearchOptions options;
+  options.bothStrands = bothStrands_->isChecked();
+  options.maxHits = static_cast<std::size_t>(kMaxShownHits + 1);
+  options.maxEdits = static_cast<unsigned>(maxEdits_->value());
+  options.useIndex = useIndex_->isChecked();
+  options.indexCacheDir = (QCoreApplication::applicationDirPath() + "/cache/mm2_index").toStdString();
+  options.cancel = cancel_.get();  // the worker's copy of cancel_ keeps it alive
+
+  watcher_ = new QFutureWatcher<QString>(this);
+  connect(watcher_, &QFutureWatcher<QString>::finished, this, [this]() {
+    const QString error = watcher_->result();
+    watcher_->deleteLater();
+    watcher_ = nullptr;
+    finishSearch(error);
+  });
+
+  const std::string path = fastaPath_->text().trimmed().toStdString();
+  watcher_->setFuture(QtConcurrent::run([this, facade = facade_, path, q, options, cancel = cancel_]() {
+    try {
+      facade->search(path, q, options, [this, cancel](const std::vector<gapneedle::SearchHit>& batch) {
+        if (cancel->load()) {
+          return false;
         }
-        table_->insertRow(row);
-        table_->setItem(row, 0, new QTableWidgetItem(QString::fromStdString(name)));
-        table_->setItem(row, 1, new QTableWidgetItem(QString::number(static_cast<qulonglong>(pos))));
-        table_->setItem(row, 2,
-                        new QTableWidgetItem(QString::number(static_cast<qulonglong>(pos + q.size()))));
-        ++row;
-        ++pos;
-      }
+        // Queued events keep their order, so every batch lands before the finished signal.
+        QMetaObject::invokeMethod(this, [this, batch]() { appendHits(batch); }, Qt::QueuedConnection);
+        return true;
+      });
+    } catch (const std::exception& e) {
+      // A cancelled index build ends in an exception; report it as a cancellation.
+      return cancel->load() ? QString() : QString::fromUtf8(e.what());
+    } catch (...) {
+      return QString("unknown search error");
     }
-  } catch (const std::exception& e) {
-    QMessageBox::critical(this, "Search failed", e.what());
+    return QString();
+  }));
+}
+
+void FastaSearchPage::appendHits(const std::vector<gapneedle::SearchHit>& batch) {
+  const int first = table_->rowCount();
+  const int take = static_cast<int>(std::min<qulonglong>(batch.size(), kMaxShownHits - std::min(hitCount_, kMaxShownHits)));
+  hitCount_ += batch.size();
+  if (take <= 0) {
+    return;
+  }
+  table_->setUpdatesEnabled(false);
+  table_->setRowCount(first + take);
+  for (int i = 0; i < take; ++i) {
+    const auto& hit = batch[static_cast<std::size_t>(i)];
+    const int row = first + i;
+    table_->setItem(row, 0, new QTableWidgetItem(QString::fromStdString(hit.seqName)));
+    table_->setItem(row, 1, new QTableWidgetItem(QString::number(static_cast<qlonglong>(hit.start))));
+    table_->setItem(row, 2, new QTableWidgetItem(QString::number(static_cast<qlonglong>(hit.end))));
+    table_->setItem(row, 3, new QTableWidgetItem(hit.reverse ? "-" : "+"));
+    table_->setItem(row, 4, new QTableWidgetItem(QString::number(hit.edits)));
+  }
+  table_->setUpdatesEnabled(true);
+  summary_->setText(QString("Searching... %1 hits").arg(hitCount_));
+}
+
+void FastaSearchPage::finishSearch(const QString& error) {
+  runBtn_->setText("Search");
+  runBtn_->setEnabled(true);
+  if (!error.isEmpty()) {
+    summary_->setText("Search failed.");
+    QMessageBox::critical(this, "Search failed", error);
+    return;
+  }
+  if (hitCount_ > kMaxShownHits) {
+    summary_->setText(QString("Showing the first %1 hits; search stopped at the display limit.").arg(kMaxShownHits));
+  } else if (cancel_->load()) {
+    summary_->setText(QString("Cancelled after %1 hits.").arg(hitCount_));
+  } else {
+    summary_->setText(QString("%1 hits.").arg(hitCount_));
   }
 }
@@ -1,21 +1,47 @@
 #pragma once
 
+#include "gapneedle/facade.hpp"
+
+#include <QFutureWatcher>
 #include <QWidget>
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class QCheckBox;
+class QLabel;
 class QLineEdit;
+class QPushButton;
+class QSpinBox;
 class QTableWidget;
 
 class FastaSearchPage : public QWidget {
   Q_OBJECT
 
  public:
-  explicit FastaSearchPage(QWidget* parent = nullptr);
+  explicit FastaSearchPage(gapneedle::GapNeedleFacade* facade, QWidget* parent = nullptr);
+  ~FastaSearchPage() override;
 
  private slots:
   void onSearch();
 
  private:
+  void appendHits(const std::vector<gapneedle::SearchHit>& batch);
+  void finishSearch(const QString& error);
+
+  gapneedle::GapNeedleFacade* facade_{nullptr};
   QLineEdit* fastaPath_{nullptr};
   QLineEdit* query_{nullptr};
+  QCheckBox* bothStrands_{nullptr};
+  QSpinBox* maxEdits_{nullptr};
+  QCheckBox* useIndex_{nullptr};
+  QPushButton* runBtn_{nullptr};
+  QLabel* summary_{nullptr};
   QTableWidget* table_{nullptr};
+
+  // The search runs on a worker thread and streams hit batches back to the UI thread.
+  QFutureWatcher<QString>* watcher_{nullptr};
+  std::shared_ptr<std::atomic<bool>> cancel_;
+  qulonglong hitCount_{0};
 };
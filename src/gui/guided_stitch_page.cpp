@@ -227,7 +227,7 @@ void GuidedStitchPage::onChooseCandidate() {
   const QString clipText = clipIndexEdit_->text().trimmed();
   if (!clipText.isEmpty()) {
     bool ok = false;
-    const int clipIndex = clipText.toInt(&ok);
+    const gapneedle::SeqPos clipIndex = clipText.toLongLong(&ok);
     if (!ok) {
       QMessageBox::warning(this, "Invalid index", "Clip index must be an integer.");
       return;
@@ -360,7 +360,7 @@ void GuidedStitchPage::refreshPathList() {
   long long total = 0;
   for (int i = 0; i < static_cast<int>(path_.size()); ++i) {
     const auto& p = path_[i];
-    const int addBp = std::max(0, p.axisEnd - p.axisStart);
+    const gapneedle::SeqPos addBp = std::max<gapneedle::SeqPos>(0, p.axisEnd - p.axisStart);
     total += addBp;
     pathList_->addItem(QString("[%1] %2:%3 %4-%5 | axis %6-%7 | +%8 bp")
                            .arg(i)
@@ -396,7 +396,7 @@ void GuidedStitchPage::refreshCandidateList() {
     return a.score > b.score;
   });
 
-  int suffixBaseAxis = -1;
+  gapneedle::SeqPos suffixBaseAxis = -1;
   if (!path_.empty()) {
     suffixBaseAxis = path_.back().axisEnd;
   }
@@ -429,14 +429,14 @@ gapneedle::GuidedConstraints GuidedStitchPage::constraintsFromUi() const {
 }
 
 bool GuidedStitchPage::tryApplyClip(gapneedle::GuidedCandidate* candidate,
-                                    int clipIndex,
+                                    gapneedle::SeqPos clipIndex,
                                     QString* errorMessage) const {
   if (!candidate) {
     if (errorMessage) *errorMessage = "internal error: null candidate";
     return false;
   }
-  const int segStart = candidate->segment.start;
-  const int segEnd = candidate->segment.end;
+  const gapneedle::SeqPos segStart = candidate->segment.start;
+  const gapneedle::SeqPos segEnd = candidate->segment.end;
   if (!(clipIndex > segStart && clipIndex <= segEnd)) {
     if (errorMessage) {
       *errorMessage = QString("Index out of range. Expected (%1, %2].").arg(segStart).arg(segEnd);
@@ -444,22 +444,22 @@ bool GuidedStitchPage::tryApplyClip(gapneedle::GuidedCandidate* candidate,
     return false;
   }
 
-  const int oldAxisEnd = candidate->axisEnd;
-  const int oldAxisStart = candidate->axisStart;
+  const gapneedle::SeqPos oldAxisEnd = candidate->axisEnd;
+  const gapneedle::SeqPos oldAxisStart = candidate->axisStart;
   candidate->unclippedAxisEnd = oldAxisEnd;
 
-  int newAxisEnd = oldAxisEnd;
+  gapneedle::SeqPos newAxisEnd = oldAxisEnd;
   if (candidate->segment.source == "t") {
     newAxisEnd = clipIndex;
   } else if (candidate->segment.source == "q") {
-    const int qSpan = segEnd - segStart;
-    const int tSpan = oldAxisEnd - oldAxisStart;
+    const gapneedle::SeqPos qSpan = segEnd - segStart;
+    const gapneedle::SeqPos tSpan = oldAxisEnd - oldAxisStart;
     if (qSpan <= 0 || tSpan <= 0) {
       if (errorMessage) *errorMessage = "Cannot clip this q-candidate due to invalid span.";
       return false;
     }
     const double ratio = static_cast<double>(clipIndex - segStart) / static_cast<double>(qSpan);
-    newAxisEnd = oldAxisStart + static_cast<int>(std::lround(ratio * static_cast<double>(tSpan)));
+    newAxisEnd = oldAxisStart + static_cast<gapneedle::SeqPos>(std::llround(ratio * static_cast<double>(tSpan)));
     newAxisEnd = std::max(oldAxisStart + 1, std::min(oldAxisEnd, newAxisEnd));
   } else {
     if (errorMessage) *errorMessage = "Clip is only supported for t/q candidates.";
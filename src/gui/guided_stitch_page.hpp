@@ -39,7 +39,7 @@ class GuidedStitchPage : public QWidget {
   void onImport();
 
  private:
-  bool tryApplyClip(gapneedle::GuidedCandidate* candidate, int clipIndex, QString* errorMessage) const;
+  bool tryApplyClip(gapneedle::GuidedCandidate* candidate, gapneedle::SeqPos clipIndex, QString* errorMessage) const;
   void loadSeedCandidates();
   void loadNextCandidates();
   void refreshPathList();
@@ -78,7 +78,7 @@ void MainWindow::setupUi() {
   pafViewerPage_ = new PafViewerPage(pages_);
   guidedPage_ = new GuidedStitchPage(&facade_, pages_);
   manualPage_ = new ManualStitchPage(&facade_, pages_);
-  searchPage_ = new FastaSearchPage(pages_);
+  searchPage_ = new FastaSearchPage(&facade_, pages_);
 
   pages_->addWidget(alignPage_);
   pages_->addWidget(pafViewerPage_);
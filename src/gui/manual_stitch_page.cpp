@@ -307,7 +307,7 @@ void ManualStitchPage::appendSegmentsFromGuide(const std::vector<gapneedle::Segm
 
 void ManualStitchPage::onBrowseTarget() {
   const QString path = QFileDialog::getOpenFileName(this, "Select target FASTA", QString(),
-                                                    "FASTA (*.fa *.fasta *.fna);;All files (*)");
+                                                    "FASTA (*.fa *.fasta *.fna *.fa.gz *.fasta.gz *.fna.gz);;All files (*)");
   if (path.isEmpty()) {
     return;
   }
@@ -320,7 +320,7 @@ void ManualStitchPage::onBrowseTarget() {
 
 void ManualStitchPage::onBrowseQuery() {
   const QString path = QFileDialog::getOpenFileName(this, "Select query FASTA", QString(),
-                                                    "FASTA (*.fa *.fasta *.fna);;All files (*)");
+                                                    "FASTA (*.fa *.fasta *.fna *.fa.gz *.fasta.gz *.fna.gz);;All files (*)");
   if (path.isEmpty()) {
     return;
   }
@@ -375,7 +375,7 @@ void ManualStitchPage::onAddExtraSource() {
     const QString p = QFileDialog::getOpenFileName(this,
                                                    QString("Select FASTA for %1").arg(key),
                                                    QString(),
-                                                   "FASTA (*.fa *.fasta *.fna);;All files (*)");
+                                                   "FASTA (*.fa *.fasta *.fna *.fa.gz *.fasta.gz *.fna.gz);;All files (*)");
     if (!p.isEmpty()) {
       path->setText(p);
     }
@@ -413,8 +413,8 @@ void ManualStitchPage::onAddSegment() {
   const QString name = seqCombo_->currentText().trimmed();
   bool okStart = false;
   bool okEnd = false;
-  const int start = startEdit_->text().replace(",", "").toInt(&okStart);
-  const int end = endEdit_->text().replace(",", "").toInt(&okEnd);
+  const gapneedle::SeqPos start = startEdit_->text().replace(",", "").toLongLong(&okStart);
+  const gapneedle::SeqPos end = endEdit_->text().replace(",", "").toLongLong(&okEnd);
   const bool reverse = reverseBtn_->property("reverse_checked").toBool();
 
   if (source.isEmpty() || name.isEmpty() || !okStart || !okEnd || end <= start) {
@@ -556,51 +556,57 @@ void ManualStitchPage::onCheckBreakpoints() {
 
   watcher->setFuture(QtConcurrent::run([segs = std::move(segs), pathBySource, context]() mutable {
     CheckTaskResult out;
-    std::unordered_map<std::string, std::shared_ptr<gapneedle::FastaIndexedReader>> cache;
-    auto readPart = [&cache, &pathBySource](const QString& sourceKey,
-                                            const QString& seqName,
-                                            int start,
-                                            int end,
-                                            bool reverse) -> QString {
-      const QString path = pathBySource.value(sourceKey).trimmed();
-      if (path.isEmpty()) {
-        throw std::runtime_error(("Missing FASTA path for source: " + sourceKey).toStdString());
-      }
-      const QFileInfo fi(path);
-      if (!fi.exists() || !fi.isFile()) {
-        throw std::runtime_error(("FASTA file not found for source " + sourceKey + ": " + path).toStdString());
-      }
-      auto it = cache.find(path.toStdString());
-      if (it == cache.end()) {
-        cache[path.toStdString()] = std::make_shared<gapneedle::FastaIndexedReader>(path.toStdString());
-        it = cache.find(path.toStdString());
-      }
-      const int len = it->second->length(seqName.toStdString());
-      if (len < 0) {
-        throw std::runtime_error(("Sequence not found: " + seqName + " in " + path).toStdString());
+    try {
+      // One batched fetch per source FASTA: each segment contributes its body and four context
+      // windows, and fetchMany coalesces neighbouring windows into shared reads. Readahead for
+      // every source is requested up front so later sources load while earlier ones are copied.
+      struct SourceBatch {
+        std::shared_ptr<const gapneedle::FastaIndexedReader> reader;
+        std::vector<std::size_t> segIndices;
+        std::vector<gapneedle::FastaRegion> regions;
+      };
+      QMap<QString, SourceBatch> batches;
+      for (std::size_t i = 0; i < segs.size(); ++i) {
+        batches[segs[i].source].segIndices.push_back(i);
       }
-      int s = std::max(0, start);
-      int e = std::min(end, len);
-      if (e <= s) return {};
-
-      if (!reverse) {
-        return QString::fromStdString(it->second->fetch(seqName.toStdString(), s, e));
+      for (auto it = batches.begin(); it != batches.end(); ++it) {
+        const QString& sourceKey = it.key();
+        SourceBatch& batch = it.value();
+        const QString path = pathBySource.value(sourceKey).trimmed();
+        if (path.isEmpty()) {
+          throw std::runtime_error(("Missing FASTA path for source: " + sourceKey).toStdString());
+        }
+        const QFileInfo fi(path);
+        if (!fi.exists() || !fi.isFile()) {
+          throw std::runtime_error(("FASTA file not found for source " + sourceKey + ": " + path).toStdString());
+        }
+        batch.reader = gapneedle::acquireFastaReader(path.toStdString());
+        batch.regions.reserve(batch.segIndices.size() * 5);
+        for (const std::size_t i : batch.segIndices) {
+          const auto& seg = segs[i];
+          const std::string name = seg.seqName.toStdString();
+          if (batch.reader->length(name) < 0) {
+            throw std::runtime_error(("Sequence not found: " + seg.seqName + " in " + path).toStdString());
+          }
+          batch.regions.push_back({name, seg.start, seg.end, seg.reverse});
+          batch.regions.push_back({name, std::max<gapneedle::SeqPos>(0, seg.start - context), seg.start, seg.reverse});
+          batch.regions.push_back({name, seg.start, seg.start + context, seg.reverse});
+          batch.regions.push_back({name, std::max<gapneedle::SeqPos>(0, seg.end - context), seg.end, seg.reverse});
+          batch.regions.push_back({name, seg.end, seg.end + context, seg.reverse});
+        }
+        batch.reader->prefetch(batch.regions);
       }
-      // Keep legacy semantics: reverse-complement whole contig first, then apply [start,end).
-      // Equivalent on original strand: fetch [len-end, len-start) and reverse-complement.
-      const int rs = std::max(0, len - e);
-      const int re = std::min(len, len - s);
-      const std::string raw = it->second->fetch(seqName.toStdString(), rs, re);
-      return QString::fromStdString(gapneedle::reverseComplement(raw));
-    };
-
-    try {
-      for (auto& seg : segs) {
-        seg.seq = readPart(seg.source, seg.seqName, seg.start, seg.end, seg.reverse);
-        seg.leftBefore = readPart(seg.source, seg.seqName, std::max(0, seg.start - context), seg.start, seg.reverse);
-        seg.leftAfter = readPart(seg.source, seg.seqName, seg.start, seg.start + context, seg.reverse);
-        seg.rightBefore = readPart(seg.source, seg.seqName, std::max(0, seg.end - context), seg.end, seg.reverse);
-        seg.rightAfter = readPart(seg.source, seg.seqName, seg.end, seg.end + context, seg.reverse);
+      for (const SourceBatch& batch : batches) {
+        const std::vector<std::string> parts = batch.reader->fetchMany(batch.regions);
+        std::size_t k = 0;
+        for (const std::size_t i : batch.segIndices) {
+          auto& seg = segs[i];
+          seg.seq = QString::fromStdString(parts[k++]);
+          seg.leftBefore = QString::fromStdString(parts[k++]);
+          seg.leftAfter = QString::fromStdString(parts[k++]);
+          seg.rightBefore = QString::fromStdString(parts[k++]);
+          seg.rightAfter = QString::fromStdString(parts[k++]);
+        }
       }
       out.segments = std::move(segs);
     } catch (const std::exception& e) {
@@ -630,15 +636,20 @@ void ManualStitchPage::onExport() {
     return;
   }
 
-  QString merged;
-  for (const auto& seg : segments_) {
-    merged += seg.seq;
+  try {
+    gapneedle::FastaWriterOptions writerOptions;
+    writerOptions.writeFai = true;
+    gapneedle::FastaWriter writer(out.toStdString(), writerOptions);
+    writer.beginRecord(QFileInfo(out).completeBaseName().toStdString());
+    for (const auto& seg : segments_) {
+      writer.append(seg.seq.toStdString());
+    }
+    writer.commit();
+  } catch (const std::exception& e) {
+    QMessageBox::critical(this, "Export failed", e.what());
+    return;
   }
 
-  gapneedle::FastaMap records;
-  records[QFileInfo(out).completeBaseName().toStdString()] = merged.toStdString();
-  gapneedle::writeFasta(out.toStdString(), records);
-
   QJsonObject root;
   root["target_fasta"] = targetFasta_->text();
   root["query_fasta"] = queryFasta_->text();
@@ -649,8 +660,8 @@ void ManualStitchPage::onExport() {
     QJsonObject s;
     s["source"] = seg.source;
     s["name"] = seg.seqName;
-    s["start"] = seg.start;
-    s["end"] = seg.end;
+    s["start"] = static_cast<qint64>(seg.start);
+    s["end"] = static_cast<qint64>(seg.end);
     s["reverse"] = seg.reverse;
     segs.append(s);
   }
@@ -702,8 +713,8 @@ void ManualStitchPage::onLoadLog() {
       SegmentItem seg;
       seg.source = s.value("source").toString();
       seg.seqName = s.value("name").toString();
-      seg.start = s.value("start").toInt();
-      seg.end = s.value("end").toInt();
+      seg.start = s.value("start").toInteger();
+      seg.end = s.value("end").toInteger();
       seg.reverse = s.value("reverse").toBool(false);
       segments_.push_back(seg);
     }
@@ -754,8 +765,8 @@ void ManualStitchPage::onLoadLog() {
       seg.reverse = true;
     }
     seg.seqName = name;
-    seg.start = m.captured(3).toInt();
-    seg.end = m.captured(4).toInt();
+    seg.start = m.captured(3).toLongLong();
+    seg.end = m.captured(4).toLongLong();
     segments_.push_back(seg);
   }
 
@@ -872,7 +883,7 @@ void ManualStitchPage::refreshSegments() {
   long long total = 0;
   for (int i = 0; i < static_cast<int>(segments_.size()); ++i) {
     const auto& seg = segments_[i];
-    const int len = seg.end - seg.start;
+    const gapneedle::SeqPos len = seg.end - seg.start;
     total += len;
     segmentList_->addItem(QString("[%1] %2:%3 %4-%5 %6bp%7")
                               .arg(i)
@@ -1087,6 +1098,18 @@ QString ManualStitchPage::renderFlankDiffHtml(const QString& label,
 }
 
 bool ManualStitchPage::materializeAll(int contextBp) {
+  // Queue readahead for every segment first so the synchronous reads below mostly hit the page cache.
+  for (const auto& seg : segments_) {
+    try {
+      const auto reader = gapneedle::acquireFastaReader(sourcePath(seg.source).toStdString());
+      const std::string name = seg.seqName.toStdString();
+      reader->prefetch({{name, seg.start, seg.end, seg.reverse},
+                        {name, std::max<gapneedle::SeqPos>(0, seg.start - contextBp), seg.start + contextBp, seg.reverse},
+                        {name, std::max<gapneedle::SeqPos>(0, seg.end - contextBp), seg.end + contextBp, seg.reverse}});
+    } catch (...) {
+      // Hints only; materializeSegment reports real failures.
+    }
+  }
   for (auto& seg : segments_) {
     if (!materializeSegment(seg, contextBp)) {
       return false;
@@ -1098,9 +1121,9 @@ bool ManualStitchPage::materializeAll(int contextBp) {
 bool ManualStitchPage::materializeSegment(SegmentItem& seg, int contextBp) {
   try {
     seg.seq = readSegment(seg.source, seg.seqName, seg.start, seg.end, seg.reverse);
-    seg.leftBefore = readSegment(seg.source, seg.seqName, std::max(0, seg.start - contextBp), seg.start, seg.reverse);
+    seg.leftBefore = readSegment(seg.source, seg.seqName, std::max<gapneedle::SeqPos>(0, seg.start - contextBp), seg.start, seg.reverse);
     seg.leftAfter = readSegment(seg.source, seg.seqName, seg.start, seg.start + contextBp, seg.reverse);
-    seg.rightBefore = readSegment(seg.source, seg.seqName, std::max(0, seg.end - contextBp), seg.end, seg.reverse);
+    seg.rightBefore = readSegment(seg.source, seg.seqName, std::max<gapneedle::SeqPos>(0, seg.end - contextBp), seg.end, seg.reverse);
     seg.rightAfter = readSegment(seg.source, seg.seqName, seg.end, seg.end + contextBp, seg.reverse);
     return true;
   } catch (const std::exception& e) {
@@ -1125,8 +1148,8 @@ QStringList ManualStitchPage::fastaNamesFast(const QString& path) const {
 
 QString ManualStitchPage::readSegment(const QString& sourceKey,
                                       const QString& seqName,
-                                      int start,
-                                      int end,
+                                      gapneedle::SeqPos start,
+                                      gapneedle::SeqPos end,
                                       bool reverse) const {
   const QString path = sourcePath(sourceKey);
   if (path.isEmpty()) {
@@ -1136,32 +1159,29 @@ QString ManualStitchPage::readSegment(const QString& sourceKey,
   if (!fi.exists() || !fi.isFile()) {
     throw std::runtime_error(("FASTA file not found for source " + sourceKey + ": " + path).toStdString());
   }
-  auto it = fastaIndexCache_.find(path.toStdString());
-  if (it == fastaIndexCache_.end()) {
-    try {
-      fastaIndexCache_[path.toStdString()] = std::make_shared<gapneedle::FastaIndexedReader>(path.toStdString());
-    } catch (const std::exception& e) {
-      throw std::runtime_error(("Failed to open FASTA for source " + sourceKey + ": " + path +
-                                " (" + e.what() + ")").toStdString());
-    }
-    it = fastaIndexCache_.find(path.toStdString());
+  std::shared_ptr<const gapneedle::FastaIndexedReader> reader;
+  try {
+    reader = gapneedle::acquireFastaReader(path.toStdString());
+  } catch (const std::exception& e) {
+    throw std::runtime_error(("Failed to open FASTA for source " + sourceKey + ": " + path +
+                              " (" + e.what() + ")").toStdString());
   }
-  const int len = it->second->length(seqName.toStdString());
+  const gapneedle::SeqPos len = reader->length(seqName.toStdString());
   if (len < 0) {
     throw std::runtime_error(("Sequence not found: " + seqName).toStdString());
   }
-  int s = std::max(0, start);
-  int e = std::min(end, len);
+  const gapneedle::SeqPos s = std::max<gapneedle::SeqPos>(0, start);
+  const gapneedle::SeqPos e = std::min(end, len);
   if (e <= s) {
     return {};
   }
 
   if (!reverse) {
-    return QString::fromStdString(it->second->fetch(seqName.toStdString(), s, e));
+    return QString::fromStdString(reader->fetch(seqName.toStdString(), s, e));
   }
-  const int rs = std::max(0, len - e);
-  const int re = std::min(len, len - s);
-  const std::string raw = it->second->fetch(seqName.toStdString(), rs, re);
+  const gapneedle::SeqPos rs = std::max<gapneedle::SeqPos>(0, len - e);
+  const gapneedle::SeqPos re = std::min(len, len - s);
+  const std::string raw = reader->fetch(seqName.toStdString(), rs, re);
   return QString::fromStdString(gapneedle::reverseComplement(raw));
 }
 
@@ -9,9 +9,7 @@
 #include <QWidget>
 
 #include <optional>
-#include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 class QComboBox;
@@ -64,8 +62,8 @@ class ManualStitchPage : public QWidget {
   struct SegmentItem {
     QString source;
     QString seqName;
-    int start{0};
-    int end{0};
+    gapneedle::SeqPos start{0};
+    gapneedle::SeqPos end{0};
     bool reverse{false};
     QString seq;
     QString leftBefore;
@@ -100,7 +98,11 @@ class ManualStitchPage : public QWidget {
   bool materializeAll(int contextBp);
   bool materializeSegment(SegmentItem& seg, int contextBp);
   QStringList fastaNamesFast(const QString& path) const;
-  QString readSegment(const QString& sourceKey, const QString& seqName, int start, int end, bool reverse) const;
+  QString readSegment(const QString& sourceKey,
+                      const QString& seqName,
+                      gapneedle::SeqPos start,
+                      gapneedle::SeqPos end,
+                      bool reverse) const;
   QString junctionPreview(const QString& left, const QString& right, int contextBp) const;
   bool allBreakpointsMatch() const;
 
@@ -129,7 +131,6 @@ class ManualStitchPage : public QWidget {
   std::vector<SegmentItem> segments_;
   QMap<QString, ExtraSourceRow> extras_;
   QMap<QString, QStringList> namesBySource_;
-  mutable std::unordered_map<std::string, std::shared_ptr<gapneedle::FastaIndexedReader>> fastaIndexCache_;
   int nextExtraId_{1};
   int materializedContextBp_{-1};
   bool checkRunning_{false};
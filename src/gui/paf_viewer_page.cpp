@@ -22,6 +22,7 @@
 #include <QVBoxLayout>
 #include <QComboBox>
 #include <QClipboard>
+#include <QDoubleSpinBox>
 #include <QWheelEvent>
 
 #include <algorithm>
@@ -33,7 +34,7 @@ QString escaped(const std::string& s) {
   return QString::fromStdString(s).toHtmlEscaped();
 }
 
-double pct(int value, int total) {
+double pct(gapneedle::SeqPos value, gapneedle::SeqPos total) {
   if (total <= 0) return 0.0;
   const double raw = (100.0 * static_cast<double>(value)) / static_cast<double>(total);
   return std::clamp(raw, 0.0, 100.0);
@@ -44,11 +45,11 @@ QString statusBadge(const QString& text, const QString& tone) {
 }
 
 QString axisBar(const QString& title,
-                int start,
-                int end,
-                int total,
+                gapneedle::SeqPos start,
+                gapneedle::SeqPos end,
+                gapneedle::SeqPos total,
                 const QString& markerLabel,
-                std::optional<int> markerPos,
+                std::optional<gapneedle::SeqPos> markerPos,
                 const QString& fillColor) {
   const double leftPct = pct(start, total);
   const double widthPct = std::max(0.0, pct(end, total) - leftPct);
@@ -146,8 +147,10 @@ PafViewerPage::PafViewerPage(QWidget* parent) : QWidget(parent) {
 
   auto* mapRow = new QHBoxLayout();
   mapRow->addWidget(new QLabel("Query index", recordsPage));
-  qPosSpin_ = new QSpinBox(recordsPage);
-  qPosSpin_->setRange(0, 1000000000);
+  // Integral double spin box: QSpinBox stops at INT_MAX, short of the longest contigs.
+  qPosSpin_ = new QDoubleSpinBox(recordsPage);
+  qPosSpin_->setDecimals(0);
+  qPosSpin_->setRange(0.0, 1e12);
   mapRow->addWidget(qPosSpin_);
   auto* mapBtn = new QPushButton("Map to target", recordsPage);
   mapBtn->setObjectName("primaryButton");
@@ -312,20 +315,20 @@ void PafViewerPage::onApplyRandomRowColor() {
   }
 }
 
-int PafViewerPage::countValue(const std::unordered_map<char, int>& m, char key) {
+gapneedle::SeqPos PafViewerPage::countValue(const std::unordered_map<char, gapneedle::SeqPos>& m, char key) {
   auto it = m.find(key);
   return it == m.end() ? 0 : it->second;
 }
 
 QString PafViewerPage::formatMappingDetail(const gapneedle::AlignmentRecord& rec, const gapneedle::MappingResult& r) const {
-  const int matchesTotal = countValue(r.countsTotal, 'M') + countValue(r.countsTotal, '=') + countValue(r.countsTotal, 'X');
-  const int insertionTotal = countValue(r.countsTotal, 'I');
-  const int deletionTotal = countValue(r.countsTotal, 'D');
-  const int skipTotal = countValue(r.countsTotal, 'N');
-  const int softTotal = countValue(r.countsTotal, 'S');
-  const int hardTotal = countValue(r.countsTotal, 'H');
-  const int padTotal = countValue(r.countsTotal, 'P');
-  const int indelBefore = countValue(r.countsBefore, 'I') + countValue(r.countsBefore, 'D');
+  const gapneedle::SeqPos matchesTotal = countValue(r.countsTotal, 'M') + countValue(r.countsTotal, '=') + countValue(r.countsTotal, 'X');
+  const gapneedle::SeqPos insertionTotal = countValue(r.countsTotal, 'I');
+  const gapneedle::SeqPos deletionTotal = countValue(r.countsTotal, 'D');
+  const gapneedle::SeqPos skipTotal = countValue(r.countsTotal, 'N');
+  const gapneedle::SeqPos softTotal = countValue(r.countsTotal, 'S');
+  const gapneedle::SeqPos hardTotal = countValue(r.countsTotal, 'H');
+  const gapneedle::SeqPos padTotal = countValue(r.countsTotal, 'P');
+  const gapneedle::SeqPos indelBefore = countValue(r.countsBefore, 'I') + countValue(r.countsBefore, 'D');
 
   QString reasonText = QString::fromStdString(r.reason);
   QString reasonTone = "warn";
@@ -438,7 +441,7 @@ void PafViewerPage::onMapQueryPosition() {
   }
 
   const auto& rec = shownRecords_[static_cast<std::size_t>(row)];
-  const int qPos = qPosSpin_->value();
+  const auto qPos = static_cast<gapneedle::SeqPos>(qPosSpin_->value());
   const auto result = gapneedle::mapQueryToTargetDetail(rec, qPos);
 
   if (result.reason == "missing_cigar") {
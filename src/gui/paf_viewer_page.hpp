@@ -9,6 +9,7 @@
 class QLabel;
 class QLineEdit;
 class QPushButton;
+class QDoubleSpinBox;
 class QSpinBox;
 class QTableWidget;
 class QTextEdit;
@@ -36,7 +37,7 @@ class PafViewerPage : public QWidget {
  private:
   void populateTable(const std::vector<gapneedle::AlignmentRecord>& records);
   QString formatMappingDetail(const gapneedle::AlignmentRecord& rec, const gapneedle::MappingResult& r) const;
-  static int countValue(const std::unordered_map<char, int>& m, char key);
+  static gapneedle::SeqPos countValue(const std::unordered_map<char, gapneedle::SeqPos>& m, char key);
 
  private:
   QLineEdit* pafPath_{nullptr};
@@ -48,7 +49,7 @@ class PafViewerPage : public QWidget {
   QComboBox* sortCombo_{nullptr};
   QTableWidget* table_{nullptr};
 
-  QSpinBox* qPosSpin_{nullptr};
+  QDoubleSpinBox* qPosSpin_{nullptr};
   QLabel* mapResultLabel_{nullptr};
   QTextEdit* mapDetail_{nullptr};
   QTabWidget* tabs_{nullptr};
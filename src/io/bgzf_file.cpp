@@ -0,0 +1,250 @@
+#include "io/bgzf_file.hpp"
+
+#include "io/fai_index.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#if GAPNEEDLE_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace gapneedle {
+
+namespace {
+
+constexpr std::size_t kBgzfHeaderSize = 18;
+constexpr std::size_t kBgzfMaxBlockSize = 65536;
+
+std::uint16_t readLe16(const unsigned char* p) {
+  return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+std::uint32_t readLe32(const unsigned char* p) {
+  return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+         (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+std::uint64_t readLe64(const unsigned char* p) {
+  return static_cast<std::uint64_t>(readLe32(p)) | (static_cast<std::uint64_t>(readLe32(p + 4)) << 32);
+}
+
+void appendLe64(std::string& out, std::uint64_t v) {
+  for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>(v >> (8 * i)));
+}
+
+// Parses a BGZF member header and returns the total block size (BSIZE + 1), or 0 if the bytes
+// are not a BGZF block.
+std::size_t bgzfBlockSize(const unsigned char* h, std::size_t n) {
+  if (n < kBgzfHeaderSize || h[0] != 0x1f || h[1] != 0x8b || h[2] != 8 || (h[3] & 4) == 0) {
+    return 0;
+  }
+  const std::size_t xlen = readLe16(h + 10);
+  std::size_t pos = 12;
+  while (pos + 4 <= 12 + xlen && pos + 4 <= n) {
+    const std::size_t slen = readLe16(h + pos + 2);
+    if (h[pos] == 'B' && h[pos + 1] == 'C' && slen == 2 && pos + 6 <= n) {
+      return static_cast<std::size_t>(readLe16(h + pos + 4)) + 1;
+    }
+    pos += 4 + slen;
+  }
+  return 0;
+}
+
+}  // namespace
+
+bool BgzfFile::isBgzf(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  unsigned char h[kBgzfHeaderSize];
+  if (!in.read(reinterpret_cast<char*>(h), sizeof(h))) {
+    return false;
+  }
+  return bgzfBlockSize(h, sizeof(h)) > 0;
+}
+
+BgzfFile::BgzfFile(const std::string& path, std::size_t cacheBlocks)
+    : path_(path), file_(path), cacheBlocks_(std::max<std::size_t>(1, cacheBlocks)) {
+#if !GAPNEEDLE_HAS_ZLIB
+  throw std::runtime_error("BGZF-compressed FASTA requires a zlib-enabled build: " + path);
+#endif
+  loadOrBuildIndex();
+}
+
+void BgzfFile::loadOrBuildIndex() {
+  // .gzi layout (htslib): uint64 count, then count pairs of (compressed, uncompressed) offsets,
+  // all little-endian; the implicit first block at (0, 0) is not stored.
+  blocks_.clear();
+  blocks_.push_back(Block{0, 0});
+  const std::string gziPath = path_ + ".gzi";
+  std::ifstream gzi(gziPath, std::ios::binary);
+  bool loaded = false;
+  std::error_code ec;
+  const auto gziTime = std::filesystem::last_write_time(gziPath, ec);
+  const bool fresh = !ec && gziTime >= std::filesystem::last_write_time(path_, ec) && !ec;
+  if (gzi && fresh) {
+    unsigned char buf[16];
+    if (gzi.read(reinterpret_cast<char*>(buf), 8)) {
+      const std::uint64_t n = readLe64(buf);
+      loaded = true;
+      for (std::uint64_t i = 0; i < n; ++i) {
+        if (!gzi.read(reinterpret_cast<char*>(buf), 16)) {
+          loaded = false;
+          break;
+        }
+        blocks_.push_back(Block{static_cast<long long>(readLe64(buf)), static_cast<long long>(readLe64(buf + 8))});
+      }
+    }
+  }
+
+  // Block headers give the compressed size and the trailing ISIZE field the uncompressed size,
+  // so the index (or the tail a stored .gzi leaves out) is rebuilt without inflating anything.
+  if (!loaded) {
+    blocks_.assign(1, Block{0, 0});
+  }
+  long long coff = blocks_.back().coffset;
+  long long uoff = blocks_.back().uoffset;
+  while (coff < file_.size()) {
+    unsigned char h[kBgzfHeaderSize];
+    if (file_.readAt(coff, sizeof(h), reinterpret_cast<char*>(h)) != sizeof(h)) break;
+    const std::size_t bsize = bgzfBlockSize(h, sizeof(h));
+    if (bsize == 0) {
+      throw std::runtime_error("Corrupt BGZF block in: " + path_);
+    }
+    unsigned char isize[4];
+    if (file_.readAt(coff + static_cast<long long>(bsize) - 4, 4, reinterpret_cast<char*>(isize)) != 4) {
+      throw std::runtime_error("Truncated BGZF block in: " + path_);
+    }
+    coff += static_cast<long long>(bsize);
+    uoff += readLe32(isize);
+    if (coff < file_.size()) {
+      blocks_.push_back(Block{coff, uoff});
+    }
+  }
+  uncompressedSize_ = uoff;
+
+  if (!loaded) {
+    std::string gziBytes;
+    appendLe64(gziBytes, blocks_.size() - 1);
+    for (std::size_t i = 1; i < blocks_.size(); ++i) {
+      appendLe64(gziBytes, static_cast<std::uint64_t>(blocks_[i].coffset));
+      appendLe64(gziBytes, static_cast<std::uint64_t>(blocks_[i].uoffset));
+    }
+    // Same protocol as the .fai: one writer at a time, published by an atomic rename. A fresh
+    // .gzi written while we waited is kept as is.
+    const BuilderLock lock(gziPath + ".lock");
+    std::error_code timeEc;
+    const auto publishedTime = std::filesystem::last_write_time(gziPath, timeEc);
+    const bool published = !timeEc && publishedTime >= std::filesystem::last_write_time(path_, timeEc) && !timeEc;
+    if (!published) {
+      try {
+        writeFileAtomically(gziPath, gziBytes);
+      } catch (const std::exception&) {
+        // Read-only location: the in-memory index is enough.
+      }
+    }
+  }
+}
+
+std::string BgzfFile::inflateBlock(std::size_t index) const {
+#if GAPNEEDLE_HAS_ZLIB
+  const long long coff = blocks_[index].coffset;
+  const long long cnext = index + 1 < blocks_.size() ? blocks_[index + 1].coffset : file_.size();
+  const long long uoff = blocks_[index].uoffset;
+  const long long unext = index + 1 < blocks_.size() ? blocks_[index + 1].uoffset : uncompressedSize_;
+  if (unext <= uoff) {
+    return {};
+  }
+
+  std::string comp(static_cast<std::size_t>(std::min<long long>(cnext - coff, kBgzfMaxBlockSize)), '\0');
+  comp.resize(file_.readAt(coff, comp.size(), comp.data()));
+  const std::size_t bsize = bgzfBlockSize(reinterpret_cast<const unsigned char*>(comp.data()), comp.size());
+  if (bsize == 0 || bsize > comp.size()) {
+    throw std::runtime_error("Corrupt BGZF block in: " + path_);
+  }
+  const std::size_t xlen = readLe16(reinterpret_cast<const unsigned char*>(comp.data()) + 10);
+  const std::size_t dataStart = 12 + xlen;
+  if (bsize < dataStart + 8) {
+    throw std::runtime_error("Corrupt BGZF block in: " + path_);
+  }
+
+  std::string out(static_cast<std::size_t>(unext - uoff), '\0');
+  z_stream zs{};
+  if (inflateInit2(&zs, -15) != Z_OK) {
+    throw std::runtime_error("Failed to initialise zlib inflate for: " + path_);
+  }
+  zs.next_in = reinterpret_cast<Bytef*>(comp.data() + dataStart);
+  zs.avail_in = static_cast<uInt>(bsize - dataStart - 8);
+  zs.next_out = reinterpret_cast<Bytef*>(out.data());
+  zs.avail_out = static_cast<uInt>(out.size());
+  const int rc = inflate(&zs, Z_FINISH);
+  inflateEnd(&zs);
+  if (rc != Z_STREAM_END || zs.total_out != out.size()) {
+    throw std::runtime_error("Failed to inflate BGZF block in: " + path_);
+  }
+  return out;
+#else
+  (void)index;
+  throw std::runtime_error("BGZF-compressed FASTA requires a zlib-enabled build: " + path_);
+#endif
+}
+
+std::shared_ptr<const std::string> BgzfFile::cachedBlock(std::size_t index) const {
+  {
+    std::lock_guard<std::mutex> lock(cacheMu_);
+    auto it = cache_.find(index);
+    if (it != cache_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second.second);
+      return it->second.first;
+    }
+  }
+  auto block = std::make_shared<const std::string>(inflateBlock(index));
+  std::lock_guard<std::mutex> lock(cacheMu_);
+  auto it = cache_.find(index);
+  if (it != cache_.end()) {
+    return it->second.first;
+  }
+  lru_.push_front(index);
+  cache_.emplace(index, std::make_pair(block, lru_.begin()));
+  while (cache_.size() > cacheBlocks_) {
+    cache_.erase(lru_.back());
+    lru_.pop_back();
+  }
+  return block;
+}
+
+std::size_t BgzfFile::read(long long offset, std::size_t len, char* out) const {
+  if (offset < 0 || offset >= uncompressedSize_ || len == 0) {
+    return 0;
+  }
+  auto it = std::upper_bound(blocks_.begin(), blocks_.end(), offset,
+                             [](long long off, const Block& b) { return off < b.uoffset; });
+  std::size_t index = static_cast<std::size_t>(std::distance(blocks_.begin(), it)) - 1;
+  std::size_t done = 0;
+  long long pos = offset;
+  while (done < len && index < blocks_.size()) {
+    const auto block = cachedBlock(index);
+    const long long within = pos - blocks_[index].uoffset;
+    if (within < static_cast<long long>(block->size())) {
+      const std::size_t take = std::min<std::size_t>(len - done, block->size() - static_cast<std::size_t>(within));
+      std::copy_n(block->data() + within, take, out + done);
+      done += take;
+      pos += static_cast<long long>(take);
+    }
+    ++index;
+  }
+  return done;
+}
+
+void BgzfFile::forEachBlock(const std::function<void(std::string_view)>& fn) const {
+  for (std::size_t i = 0; i < blocks_.size(); ++i) {
+    const std::string block = inflateBlock(i);
+    if (!block.empty()) {
+      fn(block);
+    }
+  }
+}
+
+}  // namespace gapneedle
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "io/random_access_file.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace gapneedle {
+
+// Random access to a BGZF-compressed file (bgzip output) through its `.gzi` block index.
+// The index is loaded from `<path>.gzi` when present and otherwise rebuilt by walking block
+// headers. Each instance keeps its own small LRU cache of decompressed blocks (`cacheBlocks`,
+// FastaReaderOptions::bgzfCacheBlocks for a FastaIndexedReader), shared by that instance's threads.
+class BgzfFile {
+ public:
+  BgzfFile(const std::string& path, std::size_t cacheBlocks);
+
+  static bool isBgzf(const std::string& path);
+
+  long long uncompressedSize() const { return uncompressedSize_; }
+  // Reads up to `len` uncompressed bytes at `offset`; returns the number of bytes read.
+  // Safe to call concurrently.
+  std::size_t read(long long offset, std::size_t len, char* out) const;
+  // Decompresses the whole file front to back, handing each block's bytes to `fn`.
+  void forEachBlock(const std::function<void(std::string_view)>& fn) const;
+
+ private:
+  struct Block {
+    long long coffset{0};
+    long long uoffset{0};
+  };
+
+  void loadOrBuildIndex();
+  std::string inflateBlock(std::size_t index) const;
+  std::shared_ptr<const std::string> cachedBlock(std::size_t index) const;
+
+  std::string path_;
+  RandomAccessFile file_;
+  std::vector<Block> blocks_;
+  long long uncompressedSize_{0};
+
+  std::size_t cacheBlocks_{0};
+  mutable std::mutex cacheMu_;
+  mutable std::list<std::size_t> lru_;
+  mutable std::unordered_map<std::size_t, std::pair<std::shared_ptr<const std::string>, std::list<std::size_t>::iterator>>
+      cache_;
+};
+
+}  // namespace gapneedle
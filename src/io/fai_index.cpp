@@ -0,0 +1,428 @@
+#include "io/fai_index.hpp"
+
+#include "io/bgzf_file.hpp"
+#include "io/mapped_file.hpp"
+#include "util/parallel.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gapneedle {
+
+namespace {
+
+std::string trim(const std::string& s) {
+  auto begin = s.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) {
+    return {};
+  }
+  auto end = s.find_last_not_of(" \t\r\n");
+  return s.substr(begin, end - begin + 1);
+}
+
+// Counts non-whitespace bytes; written branch-free so the compiler vectorises it.
+long long countBases(std::string_view piece) {
+  std::size_t n = 0;
+  for (char ch : piece) {
+    const unsigned char c = static_cast<unsigned char>(ch);
+    n += !(c == ' ' || (c >= '\t' && c <= '\r'));
+  }
+  return static_cast<long long>(n);
+}
+
+// Incremental .fai builder fed with consecutive chunks of (uncompressed) FASTA bytes, so the
+// same code indexes plain files, BGZF streams and the per-thread slices of a mapped file.
+// Offsets are positions in the fed stream, starting at `startOffset`.
+class FaiBuilder {
+ public:
+  explicit FaiBuilder(std::ostream& out, long long startOffset = 0) : out_(out), pos_(startOffset) {}
+
+  void feed(std::string_view chunk) {
+    std::size_t i = 0;
+    while (i < chunk.size()) {
+      if (atLineStart_) {
+        atLineStart_ = false;
+        lineStart_ = pos_ + static_cast<long long>(i);
+        inHeader_ = (chunk[i] == '>');
+        header_.clear();
+        bases_ = 0;
+      }
+      const void* nl = std::memchr(chunk.data() + i, '\n', chunk.size() - i);
+      const std::size_t stop = nl ? static_cast<std::size_t>(static_cast<const char*>(nl) - chunk.data()) : chunk.size();
+      const std::string_view piece = chunk.substr(i, stop - i);
+      if (inHeader_) {
+        header_.append(piece);
+      } else {
+        bases_ += countBases(piece);
+      }
+      if (!nl) {
+        break;
+      }
+      endLine(pos_ + static_cast<long long>(stop) + 1 - lineStart_);
+      atLineStart_ = true;
+      i = stop + 1;
+    }
+    pos_ += static_cast<long long>(chunk.size());
+  }
+
+  void finish() {
+    if (!atLineStart_) {
+      // Last line without a trailing newline: width falls back to the base count.
+      endLine(-1);
+      atLineStart_ = true;
+    }
+    flushRecord();
+  }
+
+ private:
+  void endLine(long long width) {
+    if (inHeader_) {
+      flushRecord();
+      currName_ = fastaRecordName(header_.substr(1));
+      currLen_ = 0;
+      seqOffset_ = -1;
+      headerEnd_ = width >= 0 ? lineStart_ + width : pos_;
+      lineBases_ = 0;
+      lineWidth_ = 0;
+      return;
+    }
+    if (currName_.empty() || bases_ == 0) {
+      return;
+    }
+    if (seqOffset_ < 0) {
+      seqOffset_ = lineStart_;
+      lineBases_ = bases_;
+      lineWidth_ = width >= 0 ? width : bases_;
+    }
+    currLen_ += bases_;
+  }
+
+  // A record without bases is written as samtools does: offset just past its header, no lines.
+  void flushRecord() {
+    if (!currName_.empty()) {
+      out_ << currName_ << '\t' << currLen_ << '\t' << (seqOffset_ >= 0 ? seqOffset_ : headerEnd_) << '\t'
+           << lineBases_ << '\t' << lineWidth_ << '\n';
+    }
+    currName_.clear();
+  }
+
+  std::ostream& out_;
+  long long pos_{0};
+  long long lineStart_{0};
+  bool atLineStart_{true};
+  bool inHeader_{false};
+  std::string header_;
+  long long bases_{0};
+
+  std::string currName_;
+  long long currLen_{0};
+  long long seqOffset_{-1};
+  long long headerEnd_{0};
+  long long lineBases_{0};
+  long long lineWidth_{0};
+};
+
+// Returns the offset of the first record header ('>' at a line start) at or after `from`.
+std::size_t nextHeaderStart(std::string_view data, std::size_t from) {
+  if (from == 0) {
+    return 0;
+  }
+  std::size_t i = from - 1;  // a header right at `from` is preceded by '\n' at from - 1
+  while (i < data.size()) {
+    const void* nl = std::memchr(data.data() + i, '\n', data.size() - i);
+    if (!nl) {
+      return data.size();
+    }
+    i = static_cast<std::size_t>(static_cast<const char*>(nl) - data.data()) + 1;
+    if (i < data.size() && data[i] == '>') {
+      return i;
+    }
+  }
+  return data.size();
+}
+
+std::string buildFaiText(const std::string& fastaPath) {
+  std::ostringstream out;
+  if (BgzfFile::isBgzf(fastaPath)) {
+    FaiBuilder builder(out);
+    BgzfFile bgzf(fastaPath, 1);
+    bgzf.forEachBlock([&builder](std::string_view block) { builder.feed(block); });
+    builder.finish();
+    return out.str();
+  }
+
+  MappedFile mapped;
+  try {
+    mapped = MappedFile(fastaPath);
+  } catch (const std::exception&) {
+    throw std::runtime_error("Failed to open FASTA: " + fastaPath);
+  }
+  const std::string_view data = mapped.view();
+
+  // Slice the file at record boundaries; each slice is indexed independently and the
+  // per-slice entries are concatenated in file order.
+  constexpr std::size_t kMinSliceBytes = 8u << 20;
+  const unsigned threads = defaultThreadCount();
+  const std::size_t target = std::max<std::size_t>(kMinSliceBytes, data.size() / (4 * threads) + 1);
+  std::vector<std::size_t> bounds{0};
+  while (bounds.back() < data.size()) {
+    const std::size_t guess = bounds.back() + target;
+    bounds.push_back(guess >= data.size() ? data.size() : nextHeaderStart(data, guess));
+  }
+
+  std::vector<std::string> parts(bounds.size() - 1);
+  parallelFor(parts.size(), threads, [&](std::size_t i) {
+    std::ostringstream part;
+    FaiBuilder builder(part, static_cast<long long>(bounds[i]));
+    builder.feed(data.substr(bounds[i], bounds[i + 1] - bounds[i]));
+    builder.finish();
+    parts[i] = part.str();
+  });
+  for (const auto& part : parts) {
+    out << part;
+  }
+  return out.str();
+}
+
+// Last byte (exclusive) the entry's sequence occupies in the FASTA.
+long long entryByteEnd(const FaiEntry& e) {
+  if (e.length == 0) return e.offset;
+  const long long last = e.length - 1;
+  return e.offset + (last / e.lineBases) * e.lineWidth + last % e.lineBases + 1;
+}
+
+}  // namespace
+
+std::string fastaRecordName(const std::string& header) {
+  std::string name = trim(header);
+  auto sp = name.find(' ');
+  if (sp != std::string::npos) {
+    name = name.substr(0, sp);
+  }
+  return name;
+}
+
+std::string faiPathOf(const std::string& fastaPath) {
+  return fastaPath + ".fai";
+}
+
+// An index is fresh when it is at least as new as the FASTA and every entry still fits inside
+// the file. Size is only checked for plain files: BGZF offsets address the uncompressed stream.
+bool tryLoadFreshFai(const std::string& fastaPath, FaiTable* table, std::vector<std::string>* namesOut) {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  const auto faiTime = fs::last_write_time(faiPathOf(fastaPath), ec);
+  if (ec) return false;
+  const auto fastaTime = fs::last_write_time(fastaPath, ec);
+  if (ec || faiTime < fastaTime) return false;
+  const auto fastaSize = fs::file_size(fastaPath, ec);
+  if (ec) return false;
+
+  std::vector<std::string> names;
+  try {
+    *table = parseFai(fastaPath, &names);
+  } catch (const std::exception&) {
+    return false;
+  }
+  if (!BgzfFile::isBgzf(fastaPath)) {
+    for (const auto& [name, e] : *table) {
+      if (entryByteEnd(e) > static_cast<long long>(fastaSize)) return false;
+    }
+  }
+  if (namesOut) {
+    *namesOut = std::move(names);
+  }
+  return true;
+}
+
+FaiTable parseFai(const std::string& fastaPath, std::vector<std::string>* namesOut) {
+  std::ifstream in(faiPathOf(fastaPath));
+  if (!in) {
+    throw std::runtime_error("Failed to open FASTA index (.fai): " + faiPathOf(fastaPath));
+  }
+
+  FaiTable out;
+  std::vector<std::string> names;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty()) continue;
+    std::stringstream ss(line);
+    std::string name, len, off, lbase, lwidth;
+    if (!std::getline(ss, name, '\t') ||
+        !std::getline(ss, len, '\t') ||
+        !std::getline(ss, off, '\t') ||
+        !std::getline(ss, lbase, '\t') ||
+        !std::getline(ss, lwidth, '\t')) {
+      continue;
+    }
+    FaiEntry e;
+    e.name = name;
+    e.length = std::stoll(len);
+    e.offset = std::stoll(off);
+    e.lineBases = std::stoll(lbase);
+    e.lineWidth = std::stoll(lwidth);
+    // Empty records carry no line geometry (samtools writes 0 for both).
+    if (e.name.empty() || e.length < 0 || e.offset < 0 ||
+        (e.length > 0 && (e.lineBases <= 0 || e.lineWidth <= 0))) {
+      continue;
+    }
+    if (out.emplace(e.name, e).second) {
+      names.push_back(e.name);
+    }
+  }
+  if (out.empty()) {
+    throw std::runtime_error("No valid entries in FASTA index (.fai): " + faiPathOf(fastaPath));
+  }
+  if (namesOut) {
+    *namesOut = std::move(names);
+  }
+  return out;
+}
+
+std::string temporaryPathFor(const std::string& path) {
+  static std::atomic<unsigned> counter{0};
+  const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+  std::ostringstream tmpName;
+  tmpName << path << ".tmp." << std::hash<std::thread::id>{}(std::this_thread::get_id()) << '.' << stamp << '.'
+          << counter++;
+  return tmpName.str();
+}
+
+void publishTemporary(const std::string& tmp, const std::string& path) {
+  std::error_code ec;
+  std::filesystem::rename(tmp, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmp, ec);
+    throw std::runtime_error("Failed to write file: " + path);
+  }
+}
+
+void writeFileAtomically(const std::string& path, std::string_view content) {
+  const std::string tmp = temporaryPathFor(path);
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("Failed to write file: " + path);
+    }
+    out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    out.close();
+    if (!out) {
+      std::filesystem::remove(tmp);
+      throw std::runtime_error("Failed to write file: " + path);
+    }
+  }
+  publishTemporary(tmp, path);
+}
+
+BuilderLock::BuilderLock(const std::string& lockPath) : path_(lockPath) {
+#ifdef _WIN32
+  HANDLE h = ::CreateFileA(lockPath.c_str(), GENERIC_READ | GENERIC_WRITE,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (h == INVALID_HANDLE_VALUE) {
+    return;
+  }
+  OVERLAPPED ov{};
+  if (!::LockFileEx(h, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &ov)) {
+    ::CloseHandle(h);
+    return;
+  }
+  handle_ = h;
+#else
+  for (;;) {
+    const int fd = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (fd < 0) {
+      return;
+    }
+    int rc = 0;
+    do {
+      rc = ::flock(fd, LOCK_EX);
+    } while (rc != 0 && errno == EINTR);
+    if (rc != 0) {
+      ::close(fd);
+      return;
+    }
+    // The previous holder unlinks the file before unlocking it; a lock on that orphaned inode
+    // excludes nobody, so start over on the current file.
+    struct stat held {};
+    struct stat current {};
+    if (::fstat(fd, &held) == 0 && ::stat(lockPath.c_str(), &current) == 0 && held.st_dev == current.st_dev &&
+        held.st_ino == current.st_ino) {
+      fd_ = fd;
+      return;
+    }
+    ::close(fd);
+  }
+#endif
+}
+
+BuilderLock::~BuilderLock() {
+#ifdef _WIN32
+  // The file stays: deleting it while others wait on it would let two holders coexist.
+  if (handle_ != nullptr) {
+    OVERLAPPED ov{};
+    ::UnlockFileEx(static_cast<HANDLE>(handle_), 0, 1, 0, &ov);
+    ::CloseHandle(static_cast<HANDLE>(handle_));
+  }
+#else
+  if (fd_ >= 0) {
+    ::unlink(path_.c_str());
+    ::close(fd_);
+  }
+#endif
+}
+
+bool BuilderLock::held() const {
+#ifdef _WIN32
+  return handle_ != nullptr;
+#else
+  return fd_ >= 0;
+#endif
+}
+
+void buildFai(const std::string& fastaPath) {
+  const std::string text = buildFaiText(fastaPath);
+  try {
+    writeFileAtomically(faiPathOf(fastaPath), text);
+  } catch (const std::exception&) {
+    throw std::runtime_error("Failed to write FASTA index (.fai): " + faiPathOf(fastaPath));
+  }
+}
+
+FaiTable loadOrBuildFai(const std::string& fastaPath, std::vector<std::string>* namesOut) {
+  // A valid index is reused; otherwise one process builds it under `<fai>.lock` while the others
+  // wait and then pick up the published result instead of building it again. Without a lock
+  // (read-only directory) the atomic write still keeps builders from exposing a partial index.
+  FaiTable table;
+  if (tryLoadFreshFai(fastaPath, &table, namesOut)) {
+    return table;
+  }
+  const BuilderLock lock(faiPathOf(fastaPath) + ".lock");
+  // Someone may have published a fresh index while we waited for the lock.
+  if (tryLoadFreshFai(fastaPath, &table, namesOut)) {
+    return table;
+  }
+  buildFai(fastaPath);
+  return parseFai(fastaPath, namesOut);
+}
+
+}  // namespace gapneedle
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace gapneedle {
+
+struct FaiEntry {
+  std::string name;
+  long long length{0};
+  long long offset{0};
+  long long lineBases{0};
+  long long lineWidth{0};
+};
+
+using FaiTable = std::unordered_map<std::string, FaiEntry>;
+
+// Record name of a header line (text after '>'): trimmed and cut at the first space.
+std::string fastaRecordName(const std::string& header);
+
+std::string faiPathOf(const std::string& fastaPath);
+FaiTable parseFai(const std::string& fastaPath, std::vector<std::string>* namesOut);
+// Loads `<fasta>.fai` only when it is at least as new as the FASTA and consistent with its size;
+// returns false otherwise (`namesOut` is only assigned on success). Never builds or writes anything.
+bool tryLoadFreshFai(const std::string& fastaPath, FaiTable* table, std::vector<std::string>* namesOut);
+// Builds `<fasta>.fai` (in parallel for plain files) and publishes it with an atomic rename.
+void buildFai(const std::string& fastaPath);
+FaiTable loadOrBuildFai(const std::string& fastaPath, std::vector<std::string>* namesOut);
+
+// Writes `content` to a unique temporary beside `path` and renames it into place, so readers
+// never observe a half-written file.
+void writeFileAtomically(const std::string& path, std::string_view content);
+// Building blocks for streamed atomic writes: a unique temporary name beside `path`, and the
+// rename that publishes it (the temporary is removed if the rename fails).
+std::string temporaryPathFor(const std::string& path);
+void publishTemporary(const std::string& tmp, const std::string& path);
+
+// Exclusive lock on `lockPath` for one process (or thread) building a shared sidecar file; the
+// constructor blocks until it is held. The OS releases it when its holder exits or crashes, so a
+// leftover lock file never blocks anyone. `held()` is false when the file cannot be created
+// (e.g. a read-only directory); callers then build anyway and rely on the atomic rename.
+class BuilderLock {
+ public:
+  explicit BuilderLock(const std::string& lockPath);
+  ~BuilderLock();
+  BuilderLock(const BuilderLock&) = delete;
+  BuilderLock& operator=(const BuilderLock&) = delete;
+
+  bool held() const;
+
+ private:
+  std::string path_;
+#ifdef _WIN32
+  void* handle_{nullptr};
+#else
+  int fd_{-1};
+#endif
+};
+
+}  // namespace gapneedle
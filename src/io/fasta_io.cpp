@@ -1,10 +1,24 @@
 #include "gapneedle/fasta_io.hpp"
 
+#include "gapneedle/seq_kernels.hpp"
+
+#include "io/bgzf_file.hpp"
+#include "io/fai_index.hpp"
+#include "io/gnseq_file.hpp"
+#include "io/mapped_file.hpp"
+#include "io/random_access_file.hpp"
+#include "util/file_pool.hpp"
+#include "util/io_executor.hpp"
+#include "util/parallel.hpp"
+
 #include <algorithm>
-#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <list>
 #include <memory>
-#include <sstream>
+#include <mutex>
 #include <stdexcept>
 #include <unordered_map>
 #include <unordered_set>
@@ -13,152 +27,206 @@ namespace gapneedle {
 
 namespace {
 
-std::string normalizeName(const std::string& raw) {
-  std::string name = raw;
-  auto sp = name.find(' ');
-  if (sp != std::string::npos) {
-    name = name.substr(0, sp);
-  }
-  return name;
+// Per-thread read scratch above this is released after use, so one large fetch does not stay
+// resident on every thread that ever served one.
+constexpr std::size_t kMaxRetainedScratch = std::size_t{4} << 20;
+
+long long byteOffsetOf(const FaiEntry& entry, long long pos) {
+  return entry.offset + (pos / entry.lineBases) * entry.lineWidth + pos % entry.lineBases;
 }
 
-std::string trim(const std::string& s) {
-  auto begin = s.find_first_not_of(" \t\r\n");
-  if (begin == std::string::npos) {
-    return {};
+// Walks the line-wrapped bytes of [s, e) using the .fai geometry and hands each contiguous run
+// of bases to `fn`. `raw` holds the file bytes starting at file offset `rawBase`.
+// Returns the number of bases visited.
+template <typename Fn>
+long long forEachLinePiece(std::string_view raw,
+                           long long rawBase,
+                           const FaiEntry& entry,
+                           long long s,
+                           long long e,
+                           Fn&& fn) {
+  long long pos = s;
+  while (pos < e) {
+    const long long col = pos % entry.lineBases;
+    const long long off = byteOffsetOf(entry, pos) - rawBase;
+    const long long take = std::min<long long>(entry.lineBases - col, e - pos);
+    if (off < 0 || off + take > static_cast<long long>(raw.size())) {
+      break;
+    }
+    fn(raw.substr(static_cast<std::size_t>(off), static_cast<std::size_t>(take)));
+    pos += take;
   }
-  auto end = s.find_last_not_of(" \t\r\n");
-  return s.substr(begin, end - begin + 1);
+  return pos - s;
 }
 
-struct FaiEntry {
-  std::string name;
-  long long length{0};
-  long long offset{0};
-  int lineBases{0};
-  int lineWidth{0};
+struct BlockKey {
+  const FaiEntry* entry;
+  long long block;
+  bool operator==(const BlockKey& o) const { return entry == o.entry && block == o.block; }
 };
 
-std::string faiPathOf(const std::string& fastaPath) {
-  return fastaPath + ".fai";
-}
-
-std::unordered_map<std::string, FaiEntry> parseFai(const std::string& fastaPath, std::vector<std::string>* namesOut) {
-  std::ifstream in(faiPathOf(fastaPath));
-  if (!in) {
-    throw std::runtime_error("Failed to open FASTA index (.fai): " + faiPathOf(fastaPath));
+struct BlockKeyHash {
+  std::size_t operator()(const BlockKey& k) const {
+    return std::hash<const void*>()(k.entry) ^ (static_cast<std::size_t>(k.block) * 0x9E3779B97F4A7C15ull);
   }
+};
 
-  std::unordered_map<std::string, FaiEntry> out;
-  std::string line;
-  while (std::getline(in, line)) {
-    if (line.empty()) continue;
-    std::stringstream ss(line);
-    std::string name, len, off, lbase, lwidth;
-    if (!std::getline(ss, name, '\t') ||
-        !std::getline(ss, len, '\t') ||
-        !std::getline(ss, off, '\t') ||
-        !std::getline(ss, lbase, '\t') ||
-        !std::getline(ss, lwidth, '\t')) {
-      continue;
-    }
-    FaiEntry e;
-    e.name = name;
-    e.length = std::stoll(len);
-    e.offset = std::stoll(off);
-    e.lineBases = std::stoi(lbase);
-    e.lineWidth = std::stoi(lwidth);
-    if (e.name.empty() || e.length < 0 || e.offset < 0 || e.lineBases <= 0 || e.lineWidth <= 0) {
-      continue;
-    }
-    if (out.emplace(e.name, e).second && namesOut) {
-      namesOut->push_back(e.name);
+}  // namespace
+
+struct FastaIndexedReader::Impl {
+  std::unordered_map<std::string, FaiEntry> entries;
+  std::vector<std::string> names;
+  MappedFile mapped;
+  RandomAccessFile file;
+  std::unique_ptr<BgzfFile> bgzf;
+  // .gnseq input: entries carry the record index in `offset` and no line geometry.
+  std::unique_ptr<GnseqFile> gnseq;
+
+  std::size_t blockBases{0};
+  std::size_t cacheBlocks{0};  // 0 disables the decoded block cache
+  std::mutex cacheMu;
+  std::list<BlockKey> lru;
+  std::unordered_map<BlockKey, std::pair<std::shared_ptr<const std::string>, std::list<BlockKey>::iterator>, BlockKeyHash>
+      cache;
+  std::uint64_t hits{0};
+  std::uint64_t misses{0};
+
+  const FaiEntry& entry(const std::string& seqName) const {
+    auto it = entries.find(seqName);
+    if (it == entries.end()) {
+      throw std::runtime_error("Sequence not found in FASTA index: " + seqName);
     }
+    return it->second;
   }
-  if (out.empty()) {
-    throw std::runtime_error("No valid entries in FASTA index (.fai): " + faiPathOf(fastaPath));
-  }
-  return out;
-}
 
-void buildFai(const std::string& fastaPath) {
-  std::ifstream in(fastaPath, std::ios::binary);
-  if (!in) {
-    throw std::runtime_error("Failed to open FASTA: " + fastaPath);
-  }
-  std::ofstream out(faiPathOf(fastaPath), std::ios::trunc);
-  if (!out) {
-    throw std::runtime_error("Failed to write FASTA index (.fai): " + faiPathOf(fastaPath));
+  // Returns the raw bytes covering bases [s, e) of `entry` and their file offset. Mapped readers
+  // hand out a view into the mapping; the pread and BGZF backends fill `scratch` instead.
+  std::string_view rawSpan(const FaiEntry& entry, long long s, long long e, std::string& scratch, long long* base) const {
+    const long long first = byteOffsetOf(entry, s);
+    const long long last = byteOffsetOf(entry, e - 1) + 1;
+    *base = first;
+    return rawBytes(first, last, scratch);
   }
 
-  std::string line;
-  std::string currName;
-  long long currLen = 0;
-  long long seqOffset = -1;
-  int lineBases = 0;
-  int lineWidth = 0;
-
-  std::streampos lineStart = in.tellg();
-  while (std::getline(in, line)) {
-    std::streampos nextPos = in.tellg();
-    if (!line.empty() && line.back() == '\r') line.pop_back();
+  // Copies uppercase bases [s, e) of `entry` straight from the file.
+  void copyBases(const FaiEntry& entry, long long s, long long e, char* out, const std::string& seqName) {
+    if (gnseq) {
+      gnseq->decode(static_cast<std::size_t>(entry.offset), s, e, out);
+      return;
+    }
+    thread_local std::string scratch;
+    long long base = 0;
+    const std::string_view raw = rawSpan(entry, s, e, scratch, &base);
+    char* cursor = out;
+    const long long got = forEachLinePiece(raw, base, entry, s, e, [&cursor](std::string_view piece) {
+      toUpperInto(piece.data(), piece.size(), cursor);
+      cursor += piece.size();
+    });
+    if (scratch.capacity() > kMaxRetainedScratch) {
+      std::string().swap(scratch);
+    }
+    if (got != e - s) {
+      throw std::runtime_error("Failed to fetch full sequence slice: " + seqName);
+    }
+  }
 
-    if (!line.empty() && line[0] == '>') {
-      if (!currName.empty()) {
-        out << currName << '\t' << currLen << '\t' << seqOffset << '\t'
-            << lineBases << '\t' << lineWidth << '\n';
-      }
-      currName = normalizeName(trim(line.substr(1)));
-      currLen = 0;
-      seqOffset = -1;
-      lineBases = 0;
-      lineWidth = 0;
-    } else if (!currName.empty()) {
-      int bases = 0;
-      for (char c : line) {
-        if (!std::isspace(static_cast<unsigned char>(c))) ++bases;
-      }
-      if (bases > 0) {
-        if (seqOffset < 0) {
-          seqOffset = static_cast<long long>(lineStart);
-          lineBases = bases;
-          if (nextPos != std::streampos(-1)) {
-            lineWidth = static_cast<int>(nextPos - lineStart);
-          } else {
-            lineWidth = bases;
-          }
-        }
-        currLen += bases;
+  std::shared_ptr<const std::string> cachedBlock(const FaiEntry& entry, long long block, const std::string& seqName) {
+    const BlockKey key{&entry, block};
+    {
+      std::lock_guard<std::mutex> lock(cacheMu);
+      auto it = cache.find(key);
+      if (it != cache.end()) {
+        ++hits;
+        lru.splice(lru.begin(), lru, it->second.second);
+        return it->second.first;
       }
+      ++misses;
     }
-
-    if (nextPos == std::streampos(-1)) break;
-    lineStart = nextPos;
-  }
-  if (!currName.empty()) {
-    out << currName << '\t' << currLen << '\t' << seqOffset << '\t'
-        << lineBases << '\t' << lineWidth << '\n';
+    const long long s = block * static_cast<long long>(blockBases);
+    const long long e = std::min<long long>(s + static_cast<long long>(blockBases), entry.length);
+    auto decoded = std::make_shared<std::string>(static_cast<std::size_t>(e - s), '\0');
+    copyBases(entry, s, e, decoded->data(), seqName);
+    std::shared_ptr<const std::string> blockData = std::move(decoded);
+
+    std::lock_guard<std::mutex> lock(cacheMu);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+      return it->second.first;
+    }
+    lru.push_front(key);
+    cache.emplace(key, std::make_pair(blockData, lru.begin()));
+    while (cache.size() > cacheBlocks) {
+      cache.erase(lru.back());
+      lru.pop_back();
+    }
+    return blockData;
   }
-}
 
-std::unordered_map<std::string, FaiEntry> loadOrBuildFai(const std::string& fastaPath, std::vector<std::string>* namesOut) {
-  try {
-    return parseFai(fastaPath, namesOut);
-  } catch (...) {
-    buildFai(fastaPath);
-    return parseFai(fastaPath, namesOut);
+  void adviseWillNeed(const FaiEntry& entry, long long s, long long e) const {
+    if (gnseq) {
+      gnseq->adviseWillNeed(static_cast<std::size_t>(entry.offset), s, e);
+      return;
+    }
+    const long long first = byteOffsetOf(entry, s);
+    const long long last = byteOffsetOf(entry, e - 1) + 1;
+    if (mapped.isOpen()) {
+      mapped.adviseWillNeed(static_cast<std::size_t>(first), static_cast<std::size_t>(last - first));
+    } else if (file.isOpen()) {
+      file.adviseWillNeed(first, static_cast<std::size_t>(last - first));
+    }
   }
-}
-
-}  // namespace
 
-struct FastaIndexedReader::Impl {
-  std::unordered_map<std::string, FaiEntry> entries;
-  std::vector<std::string> names;
+  // File bytes [first, last), possibly short at end of file.
+  std::string_view rawBytes(long long first, long long last, std::string& scratch) const {
+    if (mapped.isOpen()) {
+      if (first >= static_cast<long long>(mapped.size())) return {};
+      const long long stop = std::min<long long>(last, static_cast<long long>(mapped.size()));
+      return mapped.view().substr(static_cast<std::size_t>(first), static_cast<std::size_t>(stop - first));
+    }
+    scratch.resize(static_cast<std::size_t>(last - first));
+    const std::size_t got = bgzf ? bgzf->read(first, scratch.size(), scratch.data())
+                                 : file.readAt(first, scratch.size(), scratch.data());
+    return std::string_view(scratch.data(), got);
+  }
 };
 
-FastaIndexedReader::FastaIndexedReader(std::string fastaPath) : fastaPath_(std::move(fastaPath)), impl_(std::make_unique<Impl>()) {
+FastaIndexedReader::FastaIndexedReader(std::string fastaPath, FastaReaderOptions options)
+    : fastaPath_(std::move(fastaPath)), impl_(std::make_unique<Impl>()) {
+  if (GnseqFile::isGnseq(fastaPath_)) {
+    // Packed bases decode straight from the mapping, so the decoded block cache is not needed.
+    impl_->gnseq = std::make_unique<GnseqFile>(fastaPath_);
+    for (std::size_t i = 0; i < impl_->gnseq->count(); ++i) {
+      std::string name(impl_->gnseq->name(i));
+      FaiEntry entry;
+      entry.name = name;
+      entry.length = static_cast<long long>(impl_->gnseq->length(i));
+      entry.offset = static_cast<long long>(i);
+      if (impl_->entries.emplace(name, std::move(entry)).second) {
+        impl_->names.push_back(std::move(name));
+      }
+    }
+    return;
+  }
   impl_->entries = loadOrBuildFai(fastaPath_, &impl_->names);
+  if (options.blockCacheBytes > 0 && options.blockCacheBlockBases > 0) {
+    impl_->blockBases = options.blockCacheBlockBases;
+    impl_->cacheBlocks = std::max<std::size_t>(1, options.blockCacheBytes / options.blockCacheBlockBases);
+  }
+  if (BgzfFile::isBgzf(fastaPath_)) {
+    // .fai offsets of a bgzipped FASTA address the uncompressed stream.
+    impl_->bgzf = std::make_unique<BgzfFile>(fastaPath_, options.bgzfCacheBlocks);
+    return;
+  }
+  if (options.useMmap) {
+    try {
+      impl_->mapped = MappedFile(fastaPath_);
+    } catch (const std::exception&) {
+      // Fall back to positioned reads when the platform refuses the mapping.
+    }
+  }
+  if (!impl_->mapped.isOpen()) {
+    impl_->file = RandomAccessFile(fastaPath_);
+  }
 }
 
 FastaIndexedReader::~FastaIndexedReader() = default;
@@ -179,160 +247,725 @@ std::vector<std::string> FastaIndexedReader::listNames() const {
   return impl_->names;
 }
 
-int FastaIndexedReader::length(const std::string& seqName) const {
+SeqPos FastaIndexedReader::length(const std::string& seqName) const {
   auto it = impl_->entries.find(seqName);
-  return it == impl_->entries.end() ? -1 : static_cast<int>(it->second.length);
+  return it == impl_->entries.end() ? -1 : static_cast<SeqPos>(it->second.length);
 }
 
-std::string FastaIndexedReader::fetch(const std::string& seqName, int start, int end) const {
-  auto it = impl_->entries.find(seqName);
-  if (it == impl_->entries.end()) {
-    throw std::runtime_error("Sequence not found in FASTA index: " + seqName);
+std::string FastaIndexedReader::fetch(const std::string& seqName, SeqPos start, SeqPos end) const {
+  const FaiEntry& e0 = impl_->entry(seqName);
+  const long long s = std::max<long long>(0, start);
+  const long long e = std::min<long long>(end, e0.length);
+  if (e <= s) return {};
+
+  std::string out(static_cast<std::size_t>(e - s), '\0');
+  fetchInto(seqName, start, end, out.data());
+  return out;
+}
+
+std::size_t FastaIndexedReader::fetchInto(const std::string& seqName, SeqPos start, SeqPos end, char* out) const {
+  const FaiEntry& e0 = impl_->entry(seqName);
+  const long long s = std::max<long long>(0, start);
+  const long long e = std::min<long long>(end, e0.length);
+  if (e <= s) return 0;
+
+  const long long blockBases = static_cast<long long>(impl_->blockBases);
+  const long long firstBlock = blockBases > 0 ? s / blockBases : 0;
+  const long long lastBlock = blockBases > 0 ? (e - 1) / blockBases : 0;
+  if (impl_->cacheBlocks == 0 || static_cast<std::size_t>(lastBlock - firstBlock + 1) * 4 > impl_->cacheBlocks) {
+    impl_->copyBases(e0, s, e, out, seqName);
+    return static_cast<std::size_t>(e - s);
+  }
+  char* cursor = out;
+  for (long long b = firstBlock; b <= lastBlock; ++b) {
+    const auto block = impl_->cachedBlock(e0, b, seqName);
+    const long long blockStart = b * blockBases;
+    const long long from = std::max(s, blockStart) - blockStart;
+    const long long to = std::min<long long>(e - blockStart, static_cast<long long>(block->size()));
+    std::memcpy(cursor, block->data() + from, static_cast<std::size_t>(to - from));
+    cursor += to - from;
+  }
+  return static_cast<std::size_t>(e - s);
+}
+
+std::uint64_t FastaIndexedReader::sequenceDigest(const std::string& seqName) const {
+  const FaiEntry& e0 = impl_->entry(seqName);
+  if (impl_->gnseq) {
+    return impl_->gnseq->digest(static_cast<std::size_t>(e0.offset));
+  }
+  std::uint64_t digest = kSequenceDigestSeed;
+  std::string chunk;
+  for (long long pos = 0; pos < e0.length; pos += static_cast<long long>(chunk.size())) {
+    chunk.resize(static_cast<std::size_t>(std::min<long long>(e0.length - pos, 1 << 20)));
+    impl_->copyBases(e0, pos, pos + static_cast<long long>(chunk.size()), chunk.data(), seqName);
+    digest = updateSequenceDigest(digest, chunk);
+  }
+  return digest;
+}
+
+FastaBlockCacheStats FastaIndexedReader::blockCacheStats() const {
+  std::lock_guard<std::mutex> lock(impl_->cacheMu);
+  FastaBlockCacheStats stats;
+  stats.hits = impl_->hits;
+  stats.misses = impl_->misses;
+  stats.blocks = impl_->cache.size();
+  for (const auto& kv : impl_->cache) {
+    stats.bytes += kv.second.first->size();
   }
-  const FaiEntry& e0 = it->second;
-  const int seqLen = static_cast<int>(e0.length);
-  const int s = std::max(0, start);
-  const int e = std::min(end, seqLen);
+  return stats;
+}
+
+std::string FastaIndexedReader::fetch(const FastaRegion& region) const {
+  if (!region.reverse) {
+    return fetch(region.seqName, region.start, region.end);
+  }
+  const FaiEntry& e0 = impl_->entry(region.seqName);
+  const long long s = std::max<long long>(0, region.start);
+  const long long e = std::min<long long>(region.end, e0.length);
   if (e <= s) return {};
+  std::string out = fetch(region.seqName, e0.length - e, e0.length - s);
+  reverseComplementInPlace(out.data(), out.size());
+  return out;
+}
+
+void FastaIndexedReader::fetchAsync(FastaRegion region, FetchCallback done) const {
+  prefetch({region});
+  IoExecutor::instance().submit([this, region = std::move(region), done = std::move(done)]() {
+    std::string seq;
+    std::exception_ptr error;
+    try {
+      seq = fetch(region);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    done(std::move(seq), error);
+  });
+}
+
+std::future<std::string> FastaIndexedReader::fetchAsync(FastaRegion region) const {
+  auto promise = std::make_shared<std::promise<std::string>>();
+  std::future<std::string> result = promise->get_future();
+  fetchAsync(std::move(region), [promise](std::string seq, std::exception_ptr error) {
+    if (error) {
+      promise->set_exception(error);
+    } else {
+      promise->set_value(std::move(seq));
+    }
+  });
+  return result;
+}
 
-  std::ifstream in(fastaPath_, std::ios::binary);
-  if (!in) {
-    throw std::runtime_error("Failed to open FASTA: " + fastaPath_);
+void FastaIndexedReader::prefetch(const std::vector<FastaRegion>& regions) const {
+  for (const FastaRegion& r : regions) {
+    auto it = impl_->entries.find(r.seqName);
+    if (it == impl_->entries.end()) continue;
+    const FaiEntry& e0 = it->second;
+    long long s = std::max<long long>(0, r.start);
+    long long e = std::min<long long>(r.end, e0.length);
+    if (e <= s) continue;
+    if (r.reverse) {
+      const long long fs = e0.length - e;
+      e = e0.length - s;
+      s = fs;
+    }
+    impl_->adviseWillNeed(e0, s, e);
   }
-  const long long baseOffset =
-      e0.offset + static_cast<long long>(s / e0.lineBases) * e0.lineWidth + (s % e0.lineBases);
-  in.seekg(baseOffset, std::ios::beg);
-  if (!in) {
-    throw std::runtime_error("Failed to seek FASTA for sequence slice: " + seqName);
+}
+
+std::vector<std::string> FastaIndexedReader::fetchMany(const std::vector<FastaRegion>& regions) const {
+  // Byte gaps up to this size are read through rather than split into separate reads.
+  constexpr long long kCoalesceGap = 64 * 1024;
+
+  struct Planned {
+    std::size_t index;
+    const FaiEntry* entry;
+    long long s;
+    long long e;
+    long long first;
+    long long last;
+  };
+
+  std::vector<std::string> out(regions.size());
+  if (impl_->gnseq) {
+    for (std::size_t i = 0; i < regions.size(); ++i) {
+      out[i] = fetch(regions[i]);
+    }
+    return out;
+  }
+  std::vector<Planned> plan;
+  plan.reserve(regions.size());
+  for (std::size_t i = 0; i < regions.size(); ++i) {
+    const FastaRegion& r = regions[i];
+    const FaiEntry& e0 = impl_->entry(r.seqName);
+    long long s = std::max<long long>(0, r.start);
+    long long e = std::min<long long>(r.end, e0.length);
+    if (e <= s) continue;
+    if (r.reverse) {
+      const long long fs = e0.length - e;
+      e = e0.length - s;
+      s = fs;
+    }
+    plan.push_back({i, &e0, s, e, byteOffsetOf(e0, s), byteOffsetOf(e0, e - 1) + 1});
+  }
+  std::sort(plan.begin(), plan.end(), [](const Planned& a, const Planned& b) {
+    return a.first != b.first ? a.first < b.first : a.last < b.last;
+  });
+
+  std::string scratch;
+  for (std::size_t g = 0; g < plan.size();) {
+    const long long groupFirst = plan[g].first;
+    long long groupLast = plan[g].last;
+    std::size_t next = g + 1;
+    while (next < plan.size() && plan[next].first <= groupLast + kCoalesceGap) {
+      groupLast = std::max(groupLast, plan[next].last);
+      ++next;
+    }
+    const std::string_view raw = impl_->rawBytes(groupFirst, groupLast, scratch);
+    for (; g < next; ++g) {
+      const Planned& p = plan[g];
+      std::string& dst = out[p.index];
+      dst.resize(static_cast<std::size_t>(p.e - p.s));
+      char* cursor = dst.data();
+      const long long got = forEachLinePiece(raw, groupFirst, *p.entry, p.s, p.e, [&cursor](std::string_view piece) {
+        toUpperInto(piece.data(), piece.size(), cursor);
+        cursor += piece.size();
+      });
+      if (got != p.e - p.s) {
+        throw std::runtime_error("Failed to fetch full sequence slice: " + regions[p.index].seqName);
+      }
+      if (regions[p.index].reverse) {
+        reverseComplementInPlace(dst.data(), dst.size());
+      }
+    }
   }
+  return out;
+}
 
-  const int want = e - s;
-  std::string out;
-  out.reserve(static_cast<std::size_t>(want));
-  char ch = 0;
-  while (static_cast<int>(out.size()) < want && in.get(ch)) {
-    if (ch == '\n' || ch == '\r') continue;
-    out.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(ch))));
+void FastaIndexedReader::visit(const std::string& seqName,
+                               SeqPos start,
+                               SeqPos end,
+                               const std::function<void(std::string_view)>& chunk) const {
+  const FaiEntry& e0 = impl_->entry(seqName);
+  const long long s = std::max<long long>(0, start);
+  const long long e = std::min<long long>(end, e0.length);
+  if (e <= s) return;
+
+  if (impl_->gnseq) {
+    // Decoded in bounded pieces; .gnseq keeps bases uppercase only.
+    std::string piece;
+    for (long long pos = s; pos < e; pos += static_cast<long long>(piece.size())) {
+      piece.resize(static_cast<std::size_t>(std::min<long long>(e - pos, 1 << 16)));
+      impl_->copyBases(e0, pos, pos + static_cast<long long>(piece.size()), piece.data(), seqName);
+      chunk(piece);
+    }
+    return;
   }
-  if (static_cast<int>(out.size()) != want) {
+  std::string scratch;
+  long long base = 0;
+  const std::string_view raw = impl_->rawSpan(e0, s, e, scratch, &base);
+  const long long got = forEachLinePiece(raw, base, e0, s, e, chunk);
+  if (got != e - s) {
     throw std::runtime_error("Failed to fetch full sequence slice: " + seqName);
   }
-  return out;
 }
 
-FastaMap readFasta(const std::string& path) {
-  std::ifstream in(path);
-  if (!in) {
+struct FastaStreamReader::Impl {
+  std::string path;
+  std::ifstream in;
+  std::unique_ptr<BgzfFile> bgzf;
+  long long bgzfPos{0};
+  std::string buf;
+  std::size_t pos{0};
+  std::size_t end{0};
+  bool eof{false};
+  bool atLineStart{true};
+  bool inRecord{false};
+  std::string header;
+
+  bool fill() {
+    if (pos < end) return true;
+    if (eof) return false;
+    std::size_t got = 0;
+    if (bgzf) {
+      got = bgzf->read(bgzfPos, buf.size(), buf.data());
+      bgzfPos += static_cast<long long>(got);
+    } else {
+      in.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+      got = static_cast<std::size_t>(in.gcount());
+    }
+    pos = 0;
+    end = got;
+    if (got == 0) {
+      eof = true;
+      return false;
+    }
+    return true;
+  }
+
+  // Consumes the rest of the current line; appends it to `out` when given.
+  void consumeLine(std::string* out) {
+    while (fill()) {
+      const char* start = buf.data() + pos;
+      const void* nl = std::memchr(start, '\n', end - pos);
+      const std::size_t stop = nl ? static_cast<std::size_t>(static_cast<const char*>(nl) - buf.data()) : end;
+      if (out) out->append(start, stop - pos);
+      if (nl) {
+        pos = stop + 1;
+        atLineStart = true;
+        return;
+      }
+      pos = end;
+    }
+    atLineStart = true;
+  }
+
+  // Appends up to `maxBases` bases of the current record to `out`.
+  std::size_t appendBases(std::string& out, std::size_t maxBases) {
+    std::size_t added = 0;
+    while (inRecord && added < maxBases) {
+      if (!fill()) {
+        inRecord = false;
+        break;
+      }
+      if (atLineStart && buf[pos] == '>') {
+        inRecord = false;
+        break;
+      }
+      atLineStart = false;
+      while (pos < end && added < maxBases) {
+        const char* start = buf.data() + pos;
+        const void* nl = std::memchr(start, '\n', end - pos);
+        const std::size_t lineEnd = nl ? static_cast<std::size_t>(static_cast<const char*>(nl) - buf.data()) : end;
+        // Whitespace never counts as a base, so taking `maxBases - added` bytes can not overshoot.
+        const std::size_t take = std::min(lineEnd - pos, maxBases - added);
+        const std::size_t oldSize = out.size();
+        out.resize(oldSize + take);
+        const std::size_t wrote = copyUpperStripWhitespace(start, take, &out[oldSize]);
+        out.resize(oldSize + wrote);
+        added += wrote;
+        pos += take;
+        if (pos == lineEnd && nl) {
+          ++pos;
+          atLineStart = true;
+          break;
+        }
+      }
+    }
+    return added;
+  }
+};
+
+FastaStreamReader::FastaStreamReader(const std::string& path, std::size_t bufferBytes) : impl_(std::make_unique<Impl>()) {
+  impl_->path = path;
+  impl_->buf.resize(std::max<std::size_t>(bufferBytes, 4096));
+  if (BgzfFile::isBgzf(path)) {
+    impl_->bgzf = std::make_unique<BgzfFile>(path, 4);
+    return;
+  }
+  impl_->in.open(path, std::ios::binary);
+  if (!impl_->in) {
     throw std::runtime_error("Failed to open FASTA: " + path);
   }
+}
 
-  FastaMap out;
-  std::string line;
-  std::string current;
-  std::ostringstream seq;
-  while (std::getline(in, line)) {
-    if (!line.empty() && line[0] == '>') {
-      if (!current.empty()) {
-        out[current] = seq.str();
-        seq.str("");
-        seq.clear();
+FastaStreamReader::~FastaStreamReader() = default;
+FastaStreamReader::FastaStreamReader(FastaStreamReader&&) noexcept = default;
+FastaStreamReader& FastaStreamReader::operator=(FastaStreamReader&&) noexcept = default;
+
+bool FastaStreamReader::nextRecord(std::string& name) {
+  Impl& st = *impl_;
+  while (st.fill()) {
+    if (st.atLineStart && st.buf[st.pos] == '>') {
+      ++st.pos;
+      st.header.clear();
+      st.consumeLine(&st.header);
+      name = fastaRecordName(st.header);
+      // Records with an empty name are skipped, as readFasta always did.
+      st.inRecord = !name.empty();
+      if (st.inRecord) {
+        return true;
       }
-      current = normalizeName(trim(line.substr(1)));
       continue;
     }
-    if (current.empty()) {
-      continue;
+    st.consumeLine(nullptr);
+  }
+  st.inRecord = false;
+  return false;
+}
+
+bool FastaStreamReader::readChunk(std::string& chunk, std::size_t maxBases) {
+  chunk.clear();
+  return impl_->appendBases(chunk, maxBases) > 0;
+}
+
+bool FastaStreamReader::next(std::string& name, std::string& seq) {
+  if (!nextRecord(name)) {
+    return false;
+  }
+  seq.clear();
+  impl_->appendBases(seq, std::string::npos);
+  return true;
+}
+
+FastaMap readFasta(const std::string& path) {
+  if (GnseqFile::isGnseq(path)) {
+    const GnseqFile file(path);
+    FastaMap out;
+    for (std::size_t i = 0; i < file.count(); ++i) {
+      std::string seq(static_cast<std::size_t>(file.length(i)), '\0');
+      file.decode(i, 0, file.length(i), seq.data());
+      out[std::string(file.name(i))] = std::move(seq);
     }
-    for (char ch : trim(line)) {
-      if (!std::isspace(static_cast<unsigned char>(ch))) {
-        seq << static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
-      }
+    return out;
+  }
+  FastaStreamReader reader(path);
+  FastaMap out;
+  std::string name;
+  std::string seq;
+  while (reader.next(name, seq)) {
+    out[name] = seq;
+  }
+  return out;
+}
+
+PackedFastaMap readFastaPacked(const std::string& path) {
+  if (GnseqFile::isGnseq(path)) {
+    const GnseqFile file(path);
+    PackedFastaMap out;
+    std::string seq;
+    for (std::size_t i = 0; i < file.count(); ++i) {
+      seq.resize(static_cast<std::size_t>(file.length(i)));
+      file.decode(i, 0, file.length(i), seq.data());
+      PackedSequence packed(seq);
+      packed.shrinkToFit();
+      out[std::string(file.name(i))] = std::move(packed);
     }
+    return out;
   }
-  if (!current.empty()) {
-    out[current] = seq.str();
+  // Packed chunk by chunk, so only one chunk of a record is ever held unpacked.
+  FastaStreamReader reader(path);
+  PackedFastaMap out;
+  std::string name;
+  std::string chunk;
+  while (reader.nextRecord(name)) {
+    PackedSequence seq;
+    while (reader.readChunk(chunk, 1 << 20)) {
+      seq.append(chunk);
+    }
+    seq.shrinkToFit();
+    out[name] = std::move(seq);
   }
   return out;
 }
 
+namespace {
+
+FastaMap readFastaSelectedStreaming(const std::string& path, const std::vector<std::string>& names) {
+  std::unordered_set<std::string> wanted(names.begin(), names.end());
+  FastaStreamReader reader(path);
+  FastaMap out;
+  std::string name;
+  while (!wanted.empty() && reader.nextRecord(name)) {
+    auto it = wanted.find(name);
+    if (it == wanted.end()) {
+      continue;
+    }
+    wanted.erase(it);
+    std::string& seq = out[name];
+    std::string chunk;
+    while (reader.readChunk(chunk, 1 << 20)) {
+      seq += chunk;
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
 FastaMap readFastaSelected(const std::string& path, const std::vector<std::string>& names) {
   if (names.empty()) {
     return {};
   }
-  FastaMap all = readFasta(path);
-  FastaMap out;
+  std::shared_ptr<const FastaIndexedReader> reader;
+  try {
+    reader = acquireFastaReader(path);
+  } catch (const std::exception&) {
+    // No usable .fai (e.g. read-only directory): fall back to one streaming pass.
+    return readFastaSelectedStreaming(path, names);
+  }
+
+  std::vector<std::string> unique;
+  std::unordered_set<std::string> seen;
   for (const auto& name : names) {
-    auto it = all.find(name);
-    if (it != all.end()) {
-      out.emplace(it->first, it->second);
+    if (reader->length(name) >= 0 && seen.insert(name).second) {
+      unique.push_back(name);
     }
   }
+  std::vector<std::string> seqs(unique.size());
+  parallelFor(unique.size(), 0, [&](std::size_t i) {
+    seqs[i] = reader->fetch(unique[i], 0, reader->length(unique[i]));
+  });
+
+  FastaMap out;
+  for (std::size_t i = 0; i < unique.size(); ++i) {
+    out.emplace(unique[i], std::move(seqs[i]));
+  }
   return out;
 }
 
 std::vector<std::string> readFastaNames(const std::string& path) {
-  std::ifstream in(path);
-  if (!in) {
-    throw std::runtime_error("Failed to open FASTA: " + path);
+  if (GnseqFile::isGnseq(path)) {
+    return FastaIndexedReader(path).listNames();
   }
-
+  // A current index already lists every record, without touching the FASTA itself.
   std::vector<std::string> names;
+  FaiTable table;
+  if (tryLoadFreshFai(path, &table, &names)) {
+    return names;
+  }
+
+  MappedFile mapped;
+  if (!BgzfFile::isBgzf(path)) {
+    try {
+      mapped = MappedFile(path);
+    } catch (const std::exception&) {
+      // Fall through to the streaming reader, which also reports unreadable files.
+    }
+  }
   std::unordered_set<std::string> seen;
-  std::string line;
-  while (std::getline(in, line)) {
-    if (line.empty() || line[0] != '>') {
-      continue;
+  auto add = [&](std::string name) {
+    if (!name.empty() && seen.insert(name).second) {
+      names.push_back(std::move(name));
     }
-    std::string name = normalizeName(trim(line.substr(1)));
-    if (name.empty()) {
-      continue;
+  };
+  if (!mapped.isOpen()) {
+    FastaStreamReader reader(path);
+    std::string name;
+    while (reader.nextRecord(name)) {
+      add(name);
     }
-    if (seen.insert(name).second) {
-      names.push_back(std::move(name));
+    return names;
+  }
+
+  // '>' never occurs in sequence lines, so memchr (vectorised in libc) jumps from header to header
+  // and sequence bytes are only scanned, never split into lines.
+  const std::string_view text = mapped.view();
+  std::size_t pos = 0;
+  while (pos < text.size()) {
+    const void* hit = std::memchr(text.data() + pos, '>', text.size() - pos);
+    if (!hit) break;
+    const std::size_t at = static_cast<std::size_t>(static_cast<const char*>(hit) - text.data());
+    if (at > 0 && text[at - 1] != '\n') {
+      pos = at + 1;
+      continue;
     }
+    const void* nl = std::memchr(text.data() + at, '\n', text.size() - at);
+    const std::size_t lineEnd = nl ? static_cast<std::size_t>(static_cast<const char*>(nl) - text.data()) : text.size();
+    add(fastaRecordName(std::string(text.substr(at + 1, lineEnd - at - 1))));
+    pos = lineEnd;
   }
   return names;
 }
 
+namespace {
+
+FilePool<FastaIndexedReader>& readerPool() {
+  static FilePool<FastaIndexedReader> pool(16);
+  return pool;
+}
+
+}  // namespace
+
+std::shared_ptr<const FastaIndexedReader> acquireFastaReader(const std::string& fastaPath) {
+  // A slow .fai build does not block unrelated files (see FilePool::acquire).
+  return readerPool().acquire(FileVersion::of(fastaPath), {}, [&fastaPath] {
+    return std::make_shared<const FastaIndexedReader>(fastaPath);
+  });
+}
+
+void setFastaReaderPoolCapacity(std::size_t capacity) {
+  readerPool().setCapacity(capacity);
+}
+
+void clearFastaReaderPool() {
+  readerPool().clear();
+}
+
 std::vector<std::string> readFastaNamesIndexed(const std::string& path) {
-  FastaIndexedReader reader(path);
-  return reader.listNames();
+  return acquireFastaReader(path)->listNames();
 }
 
 std::string readFastaSliceIndexed(const std::string& path,
                                   const std::string& seqName,
-                                  int start,
-                                  int end) {
-  FastaIndexedReader reader(path);
-  return reader.fetch(seqName, start, end);
+                                  SeqPos start,
+                                  SeqPos end) {
+  return acquireFastaReader(path)->fetch(seqName, start, end);
 }
 
-void writeFasta(const std::string& path, const FastaMap& records) {
-  std::ofstream out(path);
-  if (!out) {
-    throw std::runtime_error("Failed to write FASTA: " + path);
+struct FastaWriter::Impl {
+  std::string path;
+  std::string tmp;
+  FastaWriterOptions options;
+  std::size_t wrap{0};
+  std::ofstream out;
+  std::string buffer;
+  std::uint64_t written{0};  // bytes already handed to `out`
+  bool committed{false};
+
+  bool inRecord{false};
+  std::size_t column{0};
+  std::string faiName;
+  SeqPos recordLength{0};
+  SeqPos recordOffset{0};
+  std::string faiText;
+
+  ~Impl() {
+    if (!committed && !tmp.empty()) {
+      out.close();
+      std::error_code ec;
+      std::filesystem::remove(tmp, ec);
+    }
+  }
+
+  void checkOpen() const {
+    if (committed) {
+      throw std::runtime_error("FASTA writer already committed: " + path);
+    }
+  }
+
+  void flush() {
+    if (buffer.empty()) return;
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!out) {
+      throw std::runtime_error("Failed to write FASTA: " + path);
+    }
+    written += buffer.size();
+    buffer.clear();
+  }
+
+  void put(const char* data, std::size_t n) {
+    if (buffer.size() + n > options.bufferBytes) {
+      flush();
+    }
+    buffer.append(data, n);
+  }
+
+  void endRecord() {
+    if (!inRecord) return;
+    if (column > 0) {
+      put("\n", 1);
+      column = 0;
+    }
+    if (options.writeFai) {
+      // Same fields FaiBuilder would derive from the written file, empty records included.
+      // Unwrapped output puts the whole record on one line.
+      const SeqPos lineBases =
+          options.lineWidth > 0 ? std::min<SeqPos>(recordLength, static_cast<SeqPos>(options.lineWidth)) : recordLength;
+      faiText += faiName;
+      faiText += '\t' + std::to_string(recordLength);
+      faiText += '\t' + std::to_string(recordOffset);
+      faiText += '\t' + std::to_string(lineBases);
+      faiText += '\t' + std::to_string(recordLength > 0 ? lineBases + 1 : 0);
+      faiText += '\n';
+    }
+    inRecord = false;
+  }
+};
+
+FastaWriter::FastaWriter(std::string path, FastaWriterOptions options) : impl_(std::make_unique<Impl>()) {
+  impl_->path = std::move(path);
+  impl_->options = options;
+  impl_->options.bufferBytes = std::max<std::size_t>(options.bufferBytes, 4096);
+  impl_->wrap = options.lineWidth > 0 ? options.lineWidth : static_cast<std::size_t>(-1);
+  impl_->tmp = temporaryPathFor(impl_->path);
+  impl_->out.open(impl_->tmp, std::ios::binary | std::ios::trunc);
+  if (!impl_->out) {
+    impl_->tmp.clear();
+    throw std::runtime_error("Failed to write FASTA: " + impl_->path);
   }
-  for (const auto& [name, seq] : records) {
-    out << '>' << name << '\n';
-    for (std::size_t i = 0; i < seq.size(); i += 80) {
-      out << seq.substr(i, std::min<std::size_t>(80, seq.size() - i)) << '\n';
+  impl_->buffer.reserve(impl_->options.bufferBytes);
+}
+
+FastaWriter::~FastaWriter() = default;
+FastaWriter::FastaWriter(FastaWriter&&) noexcept = default;
+FastaWriter& FastaWriter::operator=(FastaWriter&&) noexcept = default;
+
+void FastaWriter::beginRecord(const std::string& name) {
+  Impl& w = *impl_;
+  w.checkOpen();
+  w.endRecord();
+  w.put(">", 1);
+  w.put(name.data(), name.size());
+  w.put("\n", 1);
+  w.inRecord = true;
+  w.faiName = fastaRecordName(name);
+  w.recordLength = 0;
+  w.recordOffset = static_cast<SeqPos>(w.written + w.buffer.size());
+}
+
+void FastaWriter::append(std::string_view bases) {
+  Impl& w = *impl_;
+  w.checkOpen();
+  if (!w.inRecord) {
+    throw std::runtime_error("FASTA writer has no open record: " + w.path);
+  }
+  w.recordLength += static_cast<SeqPos>(bases.size());
+  while (!bases.empty()) {
+    const std::size_t take = std::min(w.wrap - w.column, bases.size());
+    w.put(bases.data(), take);
+    bases.remove_prefix(take);
+    w.column += take;
+    if (w.column == w.wrap) {
+      w.put("\n", 1);
+      w.column = 0;
     }
   }
 }
 
+void FastaWriter::writeRecord(const std::string& name, std::string_view bases) {
+  beginRecord(name);
+  append(bases);
+}
+
+void FastaWriter::commit() {
+  Impl& w = *impl_;
+  w.checkOpen();
+  w.endRecord();
+  w.flush();
+  w.out.close();
+  if (!w.out) {
+    throw std::runtime_error("Failed to write FASTA: " + w.path);
+  }
+  publishTemporary(w.tmp, w.path);
+  w.committed = true;
+  // The index is published after the FASTA so its mtime marks it fresh.
+  if (w.options.writeFai) {
+    writeFileAtomically(faiPathOf(w.path), w.faiText);
+  } else {
+    std::error_code ec;
+    std::filesystem::remove(faiPathOf(w.path), ec);
+  }
+}
+
+void writeFasta(const std::string& path, const FastaMap& records) {
+  std::vector<const FastaMap::value_type*> ordered;
+  ordered.reserve(records.size());
+  for (const auto& record : records) {
+    ordered.push_back(&record);
+  }
+  std::sort(ordered.begin(), ordered.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+  FastaWriter out(path);
+  for (const auto* record : ordered) {
+    out.writeRecord(record->first, record->second);
+  }
+  out.commit();
+}
+
 std::string reverseComplement(const std::string& seq) {
   std::string out;
   out.resize(seq.size());
-  for (std::size_t i = 0; i < seq.size(); ++i) {
-    char c = static_cast<char>(std::toupper(static_cast<unsigned char>(seq[seq.size() - 1 - i])));
-    switch (c) {
-      case 'A': out[i] = 'T'; break;
-      case 'T': out[i] = 'A'; break;
-      case 'C': out[i] = 'G'; break;
-      case 'G': out[i] = 'C'; break;
-      default: out[i] = 'N'; break;
-    }
-  }
+  reverseComplementInto(seq.data(), seq.size(), out.data());
   return out;
 }
 
@@ -0,0 +1,190 @@
+#include "io/gnseq_file.hpp"
+
+#include "gapneedle/fasta_io.hpp"
+#include "gapneedle/packed_sequence.hpp"
+#include "io/fai_index.hpp"
+#include "io/packed_codec.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace gapneedle {
+
+namespace {
+
+constexpr char kGnseqMagic[8] = {'G', 'N', 'S', 'E', 'Q', '\0', '\r', '\n'};
+constexpr std::uint32_t kGnseqVersion = 1;
+constexpr std::uint32_t kByteOrderMark = 0x01020304u;
+
+std::uint64_t alignUp8(std::uint64_t v) { return (v + 7) & ~std::uint64_t{7}; }
+
+bool fitsIn(std::uint64_t offset, std::uint64_t bytes, std::uint64_t fileSize) {
+  return offset <= fileSize && bytes <= fileSize - offset;
+}
+
+// Removes a half-written temporary unless the write completes.
+struct TemporaryGuard {
+  std::string path;
+  bool armed{true};
+  ~TemporaryGuard() {
+    if (armed) {
+      std::error_code ec;
+      std::filesystem::remove(path, ec);
+    }
+  }
+};
+
+template <typename T>
+void writePod(std::ofstream& out, const T* items, std::size_t count) {
+  out.write(reinterpret_cast<const char*>(items), static_cast<std::streamsize>(sizeof(T) * count));
+}
+
+}  // namespace
+
+std::uint64_t updateSequenceDigest(std::uint64_t digest, std::string_view bases) {
+  for (const char c : bases) {
+    digest ^= static_cast<unsigned char>(c);
+    digest *= 0x100000001b3ull;
+  }
+  return digest;
+}
+
+bool GnseqFile::isGnseq(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  char magic[sizeof(kGnseqMagic)] = {};
+  return in.read(magic, sizeof(magic)) && std::memcmp(magic, kGnseqMagic, sizeof(magic)) == 0;
+}
+
+GnseqFile::GnseqFile(const std::string& path) : path_(path), mapped_(path) {
+  const std::uint64_t size = mapped_.size();
+  const char* base = mapped_.data();
+  if (size < sizeof(GnseqHeader) || std::memcmp(base, kGnseqMagic, sizeof(kGnseqMagic)) != 0) {
+    throw std::runtime_error("Not a .gnseq file: " + path);
+  }
+  header_ = reinterpret_cast<const GnseqHeader*>(base);
+  if (header_->version != kGnseqVersion || header_->byteOrder != kByteOrderMark) {
+    throw std::runtime_error("Unsupported .gnseq version or byte order: " + path);
+  }
+  const std::uint64_t n = header_->sequenceCount;
+  if (header_->recordsOffset % 8 != 0 || header_->runsOffset % 8 != 0 ||
+      n > size / sizeof(GnseqRecord) || !fitsIn(header_->recordsOffset, n * sizeof(GnseqRecord), size) ||
+      header_->runsCount > size / sizeof(GnseqRun) ||
+      !fitsIn(header_->runsOffset, header_->runsCount * sizeof(GnseqRun), size) ||
+      !fitsIn(header_->namesOffset, header_->namesBytes, size)) {
+    throw std::runtime_error("Corrupt .gnseq header: " + path);
+  }
+  records_ = reinterpret_cast<const GnseqRecord*>(base + header_->recordsOffset);
+  runs_ = reinterpret_cast<const GnseqRun*>(base + header_->runsOffset);
+  names_ = base + header_->namesOffset;
+  for (std::uint64_t i = 0; i < n; ++i) {
+    const GnseqRecord& r = records_[i];
+    if (!fitsIn(r.nameOffset, r.nameLength, header_->namesBytes) || !fitsIn(r.packedOffset, (r.length + 3) / 4, size) ||
+        !fitsIn(r.runsFirst, r.runsCount, header_->runsCount)) {
+      throw std::runtime_error("Corrupt .gnseq record table: " + path);
+    }
+  }
+}
+
+std::string_view GnseqFile::name(std::size_t i) const {
+  return {names_ + records_[i].nameOffset, static_cast<std::size_t>(records_[i].nameLength)};
+}
+
+std::size_t GnseqFile::decode(std::size_t i, std::uint64_t start, std::uint64_t end, char* out) const {
+  const GnseqRecord& r = records_[i];
+  end = std::min(end, r.length);
+  if (end <= start) return 0;
+  const auto* packed = reinterpret_cast<const std::uint8_t*>(mapped_.data() + r.packedOffset);
+  decodePacked(packed, runs(i), runCount(i), static_cast<std::size_t>(start), static_cast<std::size_t>(end), out);
+  return static_cast<std::size_t>(end - start);
+}
+
+void GnseqFile::adviseWillNeed(std::size_t i, std::uint64_t start, std::uint64_t end) const {
+  const GnseqRecord& r = records_[i];
+  end = std::min(end, r.length);
+  if (end <= start) return;
+  mapped_.adviseWillNeed(static_cast<std::size_t>(r.packedOffset + start / 4),
+                         static_cast<std::size_t>((end + 3) / 4 - start / 4));
+}
+
+bool isGnseqFile(const std::string& path) { return GnseqFile::isGnseq(path); }
+
+void writeGnseq(const std::string& fastaPath, const std::string& gnseqPath) {
+  FastaStreamReader reader(fastaPath);
+  const std::string tmp = temporaryPathFor(gnseqPath);
+  TemporaryGuard guard{tmp};
+  std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Failed to write .gnseq: " + gnseqPath);
+  }
+
+  GnseqHeader header{};
+  writePod(out, &header, 1);  // placeholder, rewritten once the tables are known
+  std::uint64_t pos = sizeof(GnseqHeader);
+
+  std::vector<GnseqRecord> records;
+  std::vector<GnseqRun> runs;
+  std::string names;
+  std::string name;
+  std::string chunk;
+  while (reader.nextRecord(name)) {
+    // One record is packed in memory at a time (a quarter of its length in bytes).
+    PackedSequence seq;
+    std::uint64_t digest = kSequenceDigestSeed;
+    while (reader.readChunk(chunk, 1 << 20)) {
+      seq.append(chunk);
+      digest = updateSequenceDigest(digest, chunk);
+    }
+    GnseqRecord rec{};
+    rec.nameOffset = names.size();
+    rec.nameLength = name.size();
+    names += name;
+    rec.length = seq.size();
+    rec.packedOffset = pos;
+    rec.runsFirst = runs.size();
+    rec.runsCount = seq.ambiguityRuns().size();
+    rec.digest = digest;
+    for (const AmbiguityRun& r : seq.ambiguityRuns()) {
+      GnseqRun run{};
+      run.start = r.start;
+      run.length = r.length;
+      run.base = r.base;
+      runs.push_back(run);
+    }
+    const auto& packed = seq.packedBytes();
+    writePod(out, packed.data(), packed.size());
+    pos += packed.size();
+    records.push_back(rec);
+  }
+
+  const std::uint64_t padding = alignUp8(pos) - pos;
+  const char zeros[8] = {};
+  out.write(zeros, static_cast<std::streamsize>(padding));
+  pos += padding;
+
+  std::memcpy(header.magic, kGnseqMagic, sizeof(kGnseqMagic));
+  header.version = kGnseqVersion;
+  header.byteOrder = kByteOrderMark;
+  header.sequenceCount = records.size();
+  header.runsOffset = pos;
+  header.runsCount = runs.size();
+  header.recordsOffset = header.runsOffset + runs.size() * sizeof(GnseqRun);
+  header.namesOffset = header.recordsOffset + records.size() * sizeof(GnseqRecord);
+  header.namesBytes = names.size();
+  writePod(out, runs.data(), runs.size());
+  writePod(out, records.data(), records.size());
+  out.write(names.data(), static_cast<std::streamsize>(names.size()));
+  out.seekp(0);
+  writePod(out, &header, 1);
+  out.close();
+  if (!out) {
+    throw std::runtime_error("Failed to write .gnseq: " + gnseqPath);
+  }
+  guard.armed = false;
+  publishTemporary(tmp, gnseqPath);
+}
+
+}  // namespace gapneedle
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "io/mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace gapneedle {
+
+// `.gnseq` container: a FASTA converted once into a memory-mappable binary layout.
+//
+//   GnseqHeader                      64 bytes at offset 0
+//   packed bases                     per sequence, 4 bases per byte (PackedSequence layout)
+//   GnseqRun[runsCount]              non-ACGT runs (N gaps, IUPAC codes), 8-byte aligned
+//   GnseqRecord[sequenceCount]       one per sequence in FASTA order, 8-byte aligned
+//   name blob                        record names, not terminated
+//
+// Integers are stored in host byte order; `byteOrder` lets a reader reject foreign files.
+
+struct GnseqHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byteOrder;
+  std::uint64_t sequenceCount;
+  std::uint64_t recordsOffset;
+  std::uint64_t runsOffset;
+  std::uint64_t runsCount;
+  std::uint64_t namesOffset;
+  std::uint64_t namesBytes;
+};
+
+struct GnseqRecord {
+  std::uint64_t nameOffset;  // into the name blob
+  std::uint64_t nameLength;
+  std::uint64_t length;        // bases
+  std::uint64_t packedOffset;  // absolute file offset of the 2-bit payload
+  std::uint64_t runsFirst;     // index into the run table
+  std::uint64_t runsCount;
+  std::uint64_t digest;  // sequenceDigest of the uppercase bases
+};
+
+struct GnseqRun {
+  std::uint64_t start;
+  std::uint64_t length;
+  char base;
+  char reserved[7];
+};
+
+static_assert(sizeof(GnseqHeader) == 64, "GnseqHeader layout");
+static_assert(sizeof(GnseqRecord) == 56, "GnseqRecord layout");
+static_assert(sizeof(GnseqRun) == 24, "GnseqRun layout");
+
+// 64-bit FNV-1a over uppercase bases; chunked updates give the same value as one pass.
+constexpr std::uint64_t kSequenceDigestSeed = 0xcbf29ce484222325ull;
+std::uint64_t updateSequenceDigest(std::uint64_t digest, std::string_view bases);
+
+class GnseqFile {
+ public:
+  // True when `path` starts with the .gnseq magic.
+  static bool isGnseq(const std::string& path);
+
+  // Maps and validates the container; throws std::runtime_error on a malformed file.
+  explicit GnseqFile(const std::string& path);
+
+  std::size_t count() const { return static_cast<std::size_t>(header_->sequenceCount); }
+  std::string_view name(std::size_t i) const;
+  std::uint64_t length(std::size_t i) const { return records_[i].length; }
+  std::uint64_t digest(std::size_t i) const { return records_[i].digest; }
+  const GnseqRun* runs(std::size_t i) const { return runs_ + records_[i].runsFirst; }
+  std::size_t runCount(std::size_t i) const { return static_cast<std::size_t>(records_[i].runsCount); }
+
+  // Writes bases [start, end) of sequence `i` (clamped) into `out`; returns the count written.
+  std::size_t decode(std::size_t i, std::uint64_t start, std::uint64_t end, char* out) const;
+  // Readahead hint for the packed bytes behind [start, end) of sequence `i`.
+  void adviseWillNeed(std::size_t i, std::uint64_t start, std::uint64_t end) const;
+
+ private:
+  std::string path_;
+  MappedFile mapped_;
+  const GnseqHeader* header_{nullptr};
+  const GnseqRecord* records_{nullptr};
+  const GnseqRun* runs_{nullptr};
+  const char* names_{nullptr};
+};
+
+}  // namespace gapneedle
@@ -0,0 +1,139 @@
+#include "io/mapped_file.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gapneedle {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error("Failed to open file for mapping: " + path);
+  }
+  LARGE_INTEGER sz;
+  if (!GetFileSizeEx(file, &sz)) {
+    CloseHandle(file);
+    throw std::runtime_error("Failed to stat file for mapping: " + path);
+  }
+  fileHandle_ = file;
+  opened_ = true;
+  size_ = static_cast<std::size_t>(sz.QuadPart);
+  if (size_ == 0) {
+    return;
+  }
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr) {
+    release();
+    throw std::runtime_error("Failed to map file: " + path);
+  }
+  mappingHandle_ = mapping;
+  void* p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (p == nullptr) {
+    release();
+    throw std::runtime_error("Failed to map file: " + path);
+  }
+  data_ = static_cast<const char*>(p);
+}
+
+void MappedFile::adviseWillNeed(std::size_t, std::size_t) const {}
+
+void MappedFile::release() noexcept {
+  if (data_) UnmapViewOfFile(data_);
+  if (mappingHandle_) CloseHandle(static_cast<HANDLE>(mappingHandle_));
+  if (fileHandle_) CloseHandle(static_cast<HANDLE>(fileHandle_));
+  data_ = nullptr;
+  mappingHandle_ = nullptr;
+  fileHandle_ = nullptr;
+  size_ = 0;
+  opened_ = false;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open file for mapping: " + path);
+  }
+  struct stat st {};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error("Failed to stat file for mapping: " + path);
+  }
+  opened_ = true;
+  size_ = static_cast<std::size_t>(st.st_size);
+  if (size_ > 0) {
+    void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      ::close(fd);
+      size_ = 0;
+      opened_ = false;
+      throw std::runtime_error("Failed to map file: " + path);
+    }
+    data_ = static_cast<const char*>(p);
+  }
+  // The mapping keeps the pages alive; the descriptor is no longer needed.
+  ::close(fd);
+}
+
+void MappedFile::adviseWillNeed(std::size_t offset, std::size_t len) const {
+  if (!data_ || offset >= size_ || len == 0) return;
+  static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  const std::size_t begin = offset - offset % page;
+  const std::size_t end = std::min(size_, offset + len);
+  ::madvise(const_cast<char*>(data_) + begin, end - begin, MADV_WILLNEED);
+}
+
+void MappedFile::release() noexcept {
+  if (data_) ::munmap(const_cast<char*>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+  opened_ = false;
+}
+
+#endif
+
+MappedFile::~MappedFile() { release(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      opened_(std::exchange(other.opened_, false))
+#ifdef _WIN32
+      ,
+      fileHandle_(std::exchange(other.fileHandle_, nullptr)),
+      mappingHandle_(std::exchange(other.mappingHandle_, nullptr))
+#endif
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this == &other) return *this;
+  release();
+  data_ = std::exchange(other.data_, nullptr);
+  size_ = std::exchange(other.size_, 0);
+  opened_ = std::exchange(other.opened_, false);
+#ifdef _WIN32
+  fileHandle_ = std::exchange(other.fileHandle_, nullptr);
+  mappingHandle_ = std::exchange(other.mappingHandle_, nullptr);
+#endif
+  return *this;
+}
+
+}  // namespace gapneedle
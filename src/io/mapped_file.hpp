@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace gapneedle {
+
+// Read-only memory mapping of a whole file. Empty files map to an empty view.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+  bool isOpen() const { return opened_; }
+  std::string_view view() const { return {data_, size_}; }
+  // Hints the kernel to fault in the pages covering [offset, offset + len). Best effort.
+  void adviseWillNeed(std::size_t offset, std::size_t len) const;
+
+ private:
+  void release() noexcept;
+
+  const char* data_{nullptr};
+  std::size_t size_{0};
+  bool opened_{false};
+#ifdef _WIN32
+  void* fileHandle_{nullptr};
+  void* mappingHandle_{nullptr};
+#endif
+};
+
+}  // namespace gapneedle
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace gapneedle {
+
+// Shared 2-bit decode used by PackedSequence (heap storage) and GnseqFile (memory-mapped storage).
+// Bases are packed four per byte with the first base in the low bits; codes are A=0 C=1 G=2 T=3.
+
+inline constexpr char kPackedCodeToBase[4] = {'A', 'C', 'G', 'T'};
+
+// Each packed byte expands to four bases; decoding a byte is one 4-byte copy.
+struct PackedByteDecodeTable {
+  char bases[256][4];
+  PackedByteDecodeTable() {
+    for (int b = 0; b < 256; ++b) {
+      for (int k = 0; k < 4; ++k) {
+        bases[b][k] = kPackedCodeToBase[(b >> (2 * k)) & 3];
+      }
+    }
+  }
+};
+
+inline const PackedByteDecodeTable& packedByteDecodeTable() {
+  static const PackedByteDecodeTable table;
+  return table;
+}
+
+// Decodes bases [start, end) of `packed` into `out`, then overlays the sorted, non-overlapping
+// `runs` (any type with start/length/base members) that intersect the slice.
+template <typename Run>
+void decodePacked(const std::uint8_t* packed,
+                  const Run* runs,
+                  std::size_t runCount,
+                  std::size_t start,
+                  std::size_t end,
+                  char* out) {
+  const PackedByteDecodeTable& table = packedByteDecodeTable();
+  std::size_t pos = start;
+  char* cursor = out;
+  // Unaligned head, whole bytes, then the tail.
+  while (pos < end && (pos & 3) != 0) {
+    *cursor++ = kPackedCodeToBase[(packed[pos >> 2] >> (2 * (pos & 3))) & 3];
+    ++pos;
+  }
+  while (pos + 4 <= end) {
+    std::memcpy(cursor, table.bases[packed[pos >> 2]], 4);
+    cursor += 4;
+    pos += 4;
+  }
+  while (pos < end) {
+    *cursor++ = kPackedCodeToBase[(packed[pos >> 2] >> (2 * (pos & 3))) & 3];
+    ++pos;
+  }
+
+  const Run* it = std::upper_bound(runs, runs + runCount, start,
+                                   [](std::size_t s, const Run& r) { return s < r.start + r.length; });
+  for (; it != runs + runCount && it->start < end; ++it) {
+    const std::size_t from = std::max<std::size_t>(start, static_cast<std::size_t>(it->start));
+    const std::size_t to = std::min<std::size_t>(end, static_cast<std::size_t>(it->start + it->length));
+    std::memset(out + (from - start), static_cast<unsigned char>(it->base), to - from);
+  }
+}
+
+}  // namespace gapneedle
@@ -0,0 +1,93 @@
+#include "gapneedle/packed_sequence.hpp"
+
+#include "io/packed_codec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+
+namespace gapneedle {
+
+namespace {
+
+// 0..3 for ACGT, 4 for anything else (already uppercased).
+constexpr std::array<std::uint8_t, 256> makeBaseCodes() {
+  std::array<std::uint8_t, 256> t{};
+  for (auto& v : t) v = 4;
+  t['A'] = 0;
+  t['C'] = 1;
+  t['G'] = 2;
+  t['T'] = 3;
+  return t;
+}
+
+constexpr std::array<std::uint8_t, 256> kBaseCodes = makeBaseCodes();
+
+}  // namespace
+
+PackedSequence::PackedSequence(std::string_view seq) {
+  packed_.reserve((seq.size() + 3) / 4);
+  append(seq);
+}
+
+void PackedSequence::pushBase(char upper) {
+  std::uint8_t code = kBaseCodes[static_cast<unsigned char>(upper)];
+  if (code > 3) {
+    if (!runs_.empty() && runs_.back().base == upper && runs_.back().start + runs_.back().length == size_) {
+      ++runs_.back().length;
+    } else {
+      runs_.push_back(AmbiguityRun{size_, 1, upper});
+    }
+    code = 0;
+  }
+  const std::size_t shift = 2 * (size_ & 3);
+  if (shift == 0) {
+    packed_.push_back(0);
+  }
+  packed_.back() = static_cast<std::uint8_t>(packed_.back() | (code << shift));
+  ++size_;
+}
+
+void PackedSequence::append(std::string_view bases) {
+  for (char ch : bases) {
+    const unsigned char c = static_cast<unsigned char>(ch);
+    if (std::isspace(c)) {
+      continue;
+    }
+    pushBase(static_cast<char>(std::toupper(c)));
+  }
+}
+
+void PackedSequence::shrinkToFit() {
+  packed_.shrink_to_fit();
+  runs_.shrink_to_fit();
+}
+
+char PackedSequence::at(std::size_t pos) const {
+  char out = 'N';
+  decodeInto(pos, pos + 1, &out);
+  return out;
+}
+
+std::string PackedSequence::decode(std::size_t start, std::size_t end) const {
+  end = std::min(end, size_);
+  if (end <= start) return {};
+  std::string out(end - start, '\0');
+  decodeInto(start, end, out.data());
+  return out;
+}
+
+std::size_t PackedSequence::decodeInto(std::size_t start, std::size_t end, char* out) const {
+  end = std::min(end, size_);
+  if (end <= start) return 0;
+
+  decodePacked(packed_.data(), runs_.data(), runs_.size(), start, end, out);
+  return end - start;
+}
+
+std::size_t PackedSequence::memoryBytes() const {
+  return packed_.capacity() + runs_.capacity() * sizeof(AmbiguityRun) + sizeof(*this);
+}
+
+}  // namespace gapneedle
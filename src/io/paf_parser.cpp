@@ -1,54 +1,80 @@
 #include "gapneedle/paf.hpp"
 
+#include "io/mapped_file.hpp"
+
 #include <algorithm>
-#include <fstream>
-#include <sstream>
+#include <charconv>
+#include <cstring>
 #include <stdexcept>
+#include <string_view>
 
 namespace gapneedle {
 
+namespace {
+
+constexpr std::size_t kPafColumns = 12;
+
+template <typename T>
+bool parseNumber(std::string_view field, T& out) {
+  const char* last = field.data() + field.size();
+  const auto [ptr, ec] = std::from_chars(field.data(), last, out);
+  return ec == std::errc() && ptr == last;
+}
+
+}  // namespace
+
 std::vector<AlignmentRecord> parsePaf(const std::string& path,
                                       const std::string& targetSeq,
                                       const std::string& querySeq) {
-  std::ifstream in(path);
-  if (!in) {
+  // Multi-GB all-vs-all PAFs: fields are split in place over the mapping and only records that
+  // pass the name filter are turned into strings.
+  MappedFile file;
+  try {
+    file = MappedFile(path);
+  } catch (const std::exception&) {
     throw std::runtime_error("Failed to open PAF: " + path);
   }
 
   std::vector<AlignmentRecord> out;
-  std::string line;
-  while (std::getline(in, line)) {
-    if (line.empty()) {
-      continue;
-    }
-    std::vector<std::string> parts;
-    std::stringstream ss(line);
-    std::string item;
-    while (std::getline(ss, item, '\t')) {
-      parts.push_back(item);
+  const char* p = file.data();
+  const char* const end = p + file.size();
+  std::size_t lineNo = 0;
+  std::string_view fields[kPafColumns];
+  while (p < end) {
+    const auto* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+    const char* lineEnd = nl != nullptr ? nl : end;
+    const char* const next = nl != nullptr ? nl + 1 : end;
+    ++lineNo;
+    if (lineEnd > p && lineEnd[-1] == '\r') {
+      --lineEnd;
     }
-    if (parts.size() < 12) {
-      continue;
+
+    // Mandatory columns; `rest` is left on the first optional tag, or null when there is none.
+    std::size_t count = 0;
+    const char* rest = p;
+    while (rest != nullptr && count < kPafColumns) {
+      const auto* tab = static_cast<const char*>(std::memchr(rest, '\t', static_cast<std::size_t>(lineEnd - rest)));
+      fields[count++] = std::string_view(rest, static_cast<std::size_t>((tab != nullptr ? tab : lineEnd) - rest));
+      rest = tab != nullptr ? tab + 1 : nullptr;
     }
-    if (parts[0] != querySeq || parts[5] != targetSeq) {
+    p = next;
+    if (count < kPafColumns || fields[0] != querySeq || fields[5] != targetSeq) {
       continue;
     }
 
     AlignmentRecord r;
-    r.qName = parts[0];
-    r.qLen = std::stoi(parts[1]);
-    r.qStart = std::stoi(parts[2]);
-    r.qEnd = std::stoi(parts[3]);
-    r.strand = parts[4].empty() ? '+' : parts[4][0];
-    r.tName = parts[5];
-    r.tLen = std::stoi(parts[6]);
-    r.tStart = std::stoi(parts[7]);
-    r.tEnd = std::stoi(parts[8]);
-    r.matches = std::stoi(parts[9]);
-    r.alnLen = std::stoi(parts[10]);
-    r.mapq = std::stoi(parts[11]);
-    for (std::size_t i = 12; i < parts.size(); ++i) {
-      r.extras.push_back(parts[i]);
+    if (!parseNumber(fields[1], r.qLen) || !parseNumber(fields[2], r.qStart) || !parseNumber(fields[3], r.qEnd) ||
+        !parseNumber(fields[6], r.tLen) || !parseNumber(fields[7], r.tStart) || !parseNumber(fields[8], r.tEnd) ||
+        !parseNumber(fields[9], r.matches) || !parseNumber(fields[10], r.alnLen) || !parseNumber(fields[11], r.mapq)) {
+      throw std::runtime_error("Failed to parse PAF line " + std::to_string(lineNo) + ": " + path);
+    }
+    r.qName = querySeq;
+    r.tName = targetSeq;
+    r.strand = fields[4].empty() ? '+' : fields[4][0];
+    while (rest != nullptr && rest < lineEnd) {
+      const auto* tab = static_cast<const char*>(std::memchr(rest, '\t', static_cast<std::size_t>(lineEnd - rest)));
+      r.extras.emplace_back(rest, static_cast<std::size_t>((tab != nullptr ? tab : lineEnd) - rest));
+      rest = tab != nullptr ? tab + 1 : nullptr;
     }
     out.push_back(std::move(r));
   }
@@ -61,8 +87,8 @@ std::vector<AlignmentRecord> suggestOverlaps(const std::string& path,
                                              int limit) {
   auto records = parsePaf(path, targetSeq, querySeq);
   std::sort(records.begin(), records.end(), [](const AlignmentRecord& a, const AlignmentRecord& b) {
-    int oa = std::min(a.qEnd - a.qStart, a.tEnd - a.tStart);
-    int ob = std::min(b.qEnd - b.qStart, b.tEnd - b.tStart);
+    const SeqPos oa = std::min(a.qEnd - a.qStart, a.tEnd - a.tStart);
+    const SeqPos ob = std::min(b.qEnd - b.qStart, b.tEnd - b.tStart);
     return oa > ob;
   });
   if (limit > 0 && static_cast<int>(records.size()) > limit) {
@@ -0,0 +1,143 @@
+#include "io/random_access_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gapneedle {
+
+#ifdef _WIN32
+
+RandomAccessFile::RandomAccessFile(const std::string& path) : path_(path) {
+  HANDLE h = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (h == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error("Failed to open file: " + path);
+  }
+  LARGE_INTEGER sz;
+  if (!GetFileSizeEx(h, &sz)) {
+    CloseHandle(h);
+    throw std::runtime_error("Failed to stat file: " + path);
+  }
+  handle_ = h;
+  size_ = static_cast<long long>(sz.QuadPart);
+}
+
+bool RandomAccessFile::isOpen() const { return handle_ != nullptr; }
+
+std::size_t RandomAccessFile::readAt(long long offset, std::size_t len, char* out) const {
+  std::size_t done = 0;
+  while (done < len) {
+    OVERLAPPED ov{};
+    const unsigned long long pos = static_cast<unsigned long long>(offset) + done;
+    ov.Offset = static_cast<DWORD>(pos & 0xffffffffULL);
+    ov.OffsetHigh = static_cast<DWORD>(pos >> 32);
+    const DWORD want = static_cast<DWORD>(std::min<std::size_t>(len - done, 1u << 30));
+    DWORD got = 0;
+    if (!ReadFile(static_cast<HANDLE>(handle_), out + done, want, &got, &ov)) {
+      if (GetLastError() == ERROR_HANDLE_EOF) break;
+      throw std::runtime_error("Failed to read file: " + path_);
+    }
+    if (got == 0) break;
+    done += got;
+  }
+  return done;
+}
+
+void RandomAccessFile::adviseWillNeed(long long, std::size_t) const {}
+
+void RandomAccessFile::release() noexcept {
+  if (handle_) CloseHandle(static_cast<HANDLE>(handle_));
+  handle_ = nullptr;
+}
+
+#else
+
+RandomAccessFile::RandomAccessFile(const std::string& path) : path_(path) {
+  fd_ = ::open(path.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    throw std::runtime_error("Failed to open file: " + path);
+  }
+  struct stat st {};
+  if (::fstat(fd_, &st) != 0) {
+    release();
+    throw std::runtime_error("Failed to stat file: " + path);
+  }
+  size_ = static_cast<long long>(st.st_size);
+}
+
+bool RandomAccessFile::isOpen() const { return fd_ >= 0; }
+
+std::size_t RandomAccessFile::readAt(long long offset, std::size_t len, char* out) const {
+  std::size_t done = 0;
+  while (done < len) {
+    const ssize_t got = ::pread(fd_, out + done, len - done, static_cast<off_t>(offset + static_cast<long long>(done)));
+    if (got < 0) {
+      if (errno == EINTR) continue;
+      throw std::runtime_error("Failed to read file: " + path_);
+    }
+    if (got == 0) break;
+    done += static_cast<std::size_t>(got);
+  }
+  return done;
+}
+
+void RandomAccessFile::adviseWillNeed(long long offset, std::size_t len) const {
+#ifdef POSIX_FADV_WILLNEED
+  if (fd_ >= 0 && len > 0) {
+    ::posix_fadvise(fd_, static_cast<off_t>(offset), static_cast<off_t>(len), POSIX_FADV_WILLNEED);
+  }
+#else
+  (void)offset;
+  (void)len;
+#endif
+}
+
+void RandomAccessFile::release() noexcept {
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+}
+
+#endif
+
+RandomAccessFile::~RandomAccessFile() { release(); }
+
+RandomAccessFile::RandomAccessFile(RandomAccessFile&& other) noexcept
+    : path_(std::move(other.path_)),
+      size_(std::exchange(other.size_, 0))
+#ifdef _WIN32
+      ,
+      handle_(std::exchange(other.handle_, nullptr))
+#else
+      ,
+      fd_(std::exchange(other.fd_, -1))
+#endif
+{
+}
+
+RandomAccessFile& RandomAccessFile::operator=(RandomAccessFile&& other) noexcept {
+  if (this == &other) return *this;
+  release();
+  path_ = std::move(other.path_);
+  size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+  handle_ = std::exchange(other.handle_, nullptr);
+#else
+  fd_ = std::exchange(other.fd_, -1);
+#endif
+  return *this;
+}
+
+}  // namespace gapneedle
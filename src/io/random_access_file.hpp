@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace gapneedle {
+
+// Keeps one read-only descriptor open and serves positioned reads (pread) that are safe to
+// issue concurrently from many threads because they never touch a shared file offset.
+class RandomAccessFile {
+ public:
+  RandomAccessFile() = default;
+  explicit RandomAccessFile(const std::string& path);
+  ~RandomAccessFile();
+  RandomAccessFile(RandomAccessFile&& other) noexcept;
+  RandomAccessFile& operator=(RandomAccessFile&& other) noexcept;
+  RandomAccessFile(const RandomAccessFile&) = delete;
+  RandomAccessFile& operator=(const RandomAccessFile&) = delete;
+
+  bool isOpen() const;
+  long long size() const { return size_; }
+  // Reads up to `len` bytes at `offset` into `out`; returns the number of bytes read.
+  std::size_t readAt(long long offset, std::size_t len, char* out) const;
+  // Hints the kernel to start reading [offset, offset + len) into the page cache. Best effort.
+  void adviseWillNeed(long long offset, std::size_t len) const;
+
+ private:
+  void release() noexcept;
+
+  std::string path_;
+  long long size_{0};
+#ifdef _WIN32
+  void* handle_{nullptr};
+#else
+  int fd_{-1};
+#endif
+};
+
+}  // namespace gapneedle
@@ -0,0 +1,487 @@
+#include "gapneedle/seq_kernels.hpp"
+#include "gapneedle/seq_kernels.h"
+
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GN_SEQ_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define GN_TARGET(isa)
+#else
+#define GN_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define GN_SEQ_X86 0
+#endif
+
+namespace gapneedle {
+
+namespace {
+
+struct ScalarTables {
+  unsigned char complement[256];
+  unsigned char upper[256];
+  bool space[256];
+
+  ScalarTables() {
+    for (int c = 0; c < 256; ++c) {
+      complement[c] = 'N';
+      upper[c] = static_cast<unsigned char>(c >= 'a' && c <= 'z' ? c - 32 : c);
+      space[c] = c == ' ' || (c >= '\t' && c <= '\r');
+    }
+    const char* from = "ACGTacgt";
+    const char* to = "TGCATGCA";
+    for (int i = 0; i < 8; ++i) {
+      complement[static_cast<unsigned char>(from[i])] = static_cast<unsigned char>(to[i]);
+    }
+  }
+};
+
+const ScalarTables& tables() {
+  static const ScalarTables t;
+  return t;
+}
+
+// ---- portable scalar implementations ----
+
+void rcIntoScalar(const char* in, std::size_t n, char* out) {
+  const auto& t = tables();
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = static_cast<char>(t.complement[static_cast<unsigned char>(in[n - 1 - i])]);
+  }
+}
+
+void rcInPlaceScalar(char* seq, std::size_t n) {
+  const auto& t = tables();
+  std::size_t lo = 0;
+  std::size_t hi = n;
+  while (hi - lo >= 2) {
+    const char a = seq[lo];
+    seq[lo++] = static_cast<char>(t.complement[static_cast<unsigned char>(seq[--hi])]);
+    seq[hi] = static_cast<char>(t.complement[static_cast<unsigned char>(a)]);
+  }
+  if (lo < hi) {
+    seq[lo] = static_cast<char>(t.complement[static_cast<unsigned char>(seq[lo])]);
+  }
+}
+
+void upperIntoScalar(const char* in, std::size_t n, char* out) {
+  const auto& t = tables();
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = static_cast<char>(t.upper[static_cast<unsigned char>(in[i])]);
+  }
+}
+
+std::size_t stripScalar(const char* in, std::size_t n, char* out) {
+  const auto& t = tables();
+  std::size_t w = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const unsigned char c = static_cast<unsigned char>(in[i]);
+    if (!t.space[c]) {
+      out[w++] = static_cast<char>(t.upper[c]);
+    }
+  }
+  return w;
+}
+
+bool isGapByte(char c, bool caseInsensitive) {
+  return caseInsensitive ? (c | 0x20) == 'n' : c == 'N';
+}
+
+std::size_t findGapScalar(const char* in, std::size_t n, bool caseInsensitive) {
+  std::size_t i = 0;
+  while (i < n && !isGapByte(in[i], caseInsensitive)) ++i;
+  return i;
+}
+
+std::size_t gapRunScalar(const char* in, std::size_t n, bool caseInsensitive) {
+  std::size_t i = 0;
+  while (i < n && isGapByte(in[i], caseInsensitive)) ++i;
+  return i;
+}
+
+bool matchesEither(const char* at, const char* first, const char* second, std::size_t m) {
+  return std::memcmp(at, first, m) == 0 || std::memcmp(at, second, m) == 0;
+}
+
+std::size_t findPatternPairScalar(const char* in, std::size_t n, const char* first, const char* second, std::size_t m) {
+  for (std::size_t i = 0; i < n; ++i) {
+    if ((in[i] == first[0] || in[i] == second[0]) && matchesEither(in + i, first, second, m)) return i;
+  }
+  return n;
+}
+
+#if GN_SEQ_X86
+
+inline unsigned lowestSetBit(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index = 0;
+  _BitScanForward(&index, mask);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// ---- SSE4.1: 16 bytes per step ----
+// Complement uses a pshufb lookup on the low nibble (A=1, C=3, G=7, T=4 for both cases) and a
+// validity mask so every other byte becomes 'N'.
+
+GN_TARGET("sse4.1") inline __m128i upper16(__m128i v) {
+  const __m128i isLower = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1)));
+  return _mm_sub_epi8(v, _mm_and_si128(isLower, _mm_set1_epi8(0x20)));
+}
+
+GN_TARGET("sse4.1") inline __m128i complement16(__m128i v) {
+  const __m128i lut = _mm_setr_epi8('N', 'T', 'N', 'G', 'A', 'N', 'N', 'C', 'N', 'N', 'N', 'N', 'N', 'N', 'N', 'N');
+  const __m128i comp = _mm_shuffle_epi8(lut, _mm_and_si128(v, _mm_set1_epi8(0x0F)));
+  const __m128i u = _mm_and_si128(v, _mm_set1_epi8(static_cast<char>(0xDF)));
+  const __m128i valid = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(u, _mm_set1_epi8('A')), _mm_cmpeq_epi8(u, _mm_set1_epi8('C'))),
+                                     _mm_or_si128(_mm_cmpeq_epi8(u, _mm_set1_epi8('G')), _mm_cmpeq_epi8(u, _mm_set1_epi8('T'))));
+  return _mm_blendv_epi8(_mm_set1_epi8('N'), comp, valid);
+}
+
+GN_TARGET("sse4.1") inline __m128i reverse16(__m128i v) {
+  return _mm_shuffle_epi8(v, _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+GN_TARGET("sse4.1") inline int whitespaceMask16(__m128i v) {
+  const __m128i ctl = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1)));
+  return _mm_movemask_epi8(_mm_or_si128(ctl, _mm_cmpeq_epi8(v, _mm_set1_epi8(' '))));
+}
+
+// Bit i is set when byte i is a gap byte; OR-ing 0x20 folds 'N' onto 'n' and nothing else.
+GN_TARGET("sse4.1") inline unsigned gapMask16(__m128i v, bool caseInsensitive) {
+  const __m128i folded = caseInsensitive ? _mm_or_si128(v, _mm_set1_epi8(0x20)) : v;
+  return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(folded, _mm_set1_epi8(caseInsensitive ? 'n' : 'N'))));
+}
+
+GN_TARGET("sse4.1") void rcIntoSse41(const char* in, std::size_t n, char* out) {
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + n - i - 16));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), complement16(reverse16(v)));
+  }
+  rcIntoScalar(in, n - i, out + i);
+}
+
+GN_TARGET("sse4.1") void rcInPlaceSse41(char* seq, std::size_t n) {
+  std::size_t lo = 0;
+  std::size_t hi = n;
+  while (hi - lo >= 32) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(seq + lo));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(seq + hi - 16));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(seq + lo), complement16(reverse16(b)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(seq + hi - 16), complement16(reverse16(a)));
+    lo += 16;
+    hi -= 16;
+  }
+  rcInPlaceScalar(seq + lo, hi - lo);
+}
+
+GN_TARGET("sse4.1") void upperIntoSse41(const char* in, std::size_t n, char* out) {
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), upper16(v));
+  }
+  upperIntoScalar(in + i, n - i, out + i);
+}
+
+GN_TARGET("sse4.1") std::size_t stripSse41(const char* in, std::size_t n, char* out) {
+  std::size_t i = 0;
+  std::size_t w = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    if (whitespaceMask16(v) == 0) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + w), upper16(v));
+      w += 16;
+    } else {
+      w += stripScalar(in + i, 16, out + w);
+    }
+  }
+  return w + stripScalar(in + i, n - i, out + w);
+}
+
+GN_TARGET("sse4.1") std::size_t findGapSse41(const char* in, std::size_t n, bool caseInsensitive) {
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const unsigned mask = gapMask16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), caseInsensitive);
+    if (mask != 0) return i + lowestSetBit(mask);
+  }
+  return i + findGapScalar(in + i, n - i, caseInsensitive);
+}
+
+GN_TARGET("sse4.1") std::size_t gapRunSse41(const char* in, std::size_t n, bool caseInsensitive) {
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const unsigned mask = gapMask16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), caseInsensitive) ^ 0xFFFFu;
+    if (mask != 0) return i + lowestSetBit(mask);
+  }
+  return i + gapRunScalar(in + i, n - i, caseInsensitive);
+}
+
+// Substring search in the style of the SIMD strstr: 16 candidate starts are tested at once on
+// three anchor bytes (first, second, last) of both patterns, and only surviving positions are
+// compared in full, without leaving the loop.
+GN_TARGET("sse4.1") std::size_t findPatternPairSse41(const char* in, std::size_t n, const char* first,
+                                                     const char* second, std::size_t m) {
+  const std::size_t mid = m > 1 ? 1 : 0;
+  const __m128i f0 = _mm_set1_epi8(first[0]);
+  const __m128i f1 = _mm_set1_epi8(first[mid]);
+  const __m128i f2 = _mm_set1_epi8(first[m - 1]);
+  const __m128i s0 = _mm_set1_epi8(second[0]);
+  const __m128i s1 = _mm_set1_epi8(second[mid]);
+  const __m128i s2 = _mm_set1_epi8(second[m - 1]);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + mid));
+    const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + m - 1));
+    const __m128i hitFirst =
+        _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(b0, f0), _mm_cmpeq_epi8(b1, f1)), _mm_cmpeq_epi8(b2, f2));
+    const __m128i hitSecond =
+        _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(b0, s0), _mm_cmpeq_epi8(b1, s1)), _mm_cmpeq_epi8(b2, s2));
+    for (unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(hitFirst, hitSecond))); mask != 0;
+         mask &= mask - 1) {
+      const std::size_t at = i + lowestSetBit(mask);
+      if (matchesEither(in + at, first, second, m)) return at;
+    }
+  }
+  return i + findPatternPairScalar(in + i, n - i, first, second, m);
+}
+
+// ---- AVX2: 32 bytes per step, same scheme with the lookup table repeated per lane ----
+
+GN_TARGET("avx2") inline __m256i upper32(__m256i v) {
+  const __m256i isLower = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('a' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), v));
+  return _mm256_sub_epi8(v, _mm256_and_si256(isLower, _mm256_set1_epi8(0x20)));
+}
+
+GN_TARGET("avx2") inline __m256i complement32(__m256i v) {
+  const __m256i lut = _mm256_setr_epi8('N', 'T', 'N', 'G', 'A', 'N', 'N', 'C', 'N', 'N', 'N', 'N', 'N', 'N', 'N', 'N',
+                                       'N', 'T', 'N', 'G', 'A', 'N', 'N', 'C', 'N', 'N', 'N', 'N', 'N', 'N', 'N', 'N');
+  const __m256i comp = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, _mm256_set1_epi8(0x0F)));
+  const __m256i u = _mm256_and_si256(v, _mm256_set1_epi8(static_cast<char>(0xDF)));
+  const __m256i valid =
+      _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(u, _mm256_set1_epi8('A')), _mm256_cmpeq_epi8(u, _mm256_set1_epi8('C'))),
+                      _mm256_or_si256(_mm256_cmpeq_epi8(u, _mm256_set1_epi8('G')), _mm256_cmpeq_epi8(u, _mm256_set1_epi8('T'))));
+  return _mm256_blendv_epi8(_mm256_set1_epi8('N'), comp, valid);
+}
+
+GN_TARGET("avx2") inline __m256i reverse32(__m256i v) {
+  const __m256i idx = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                       15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  const __m256i inLane = _mm256_shuffle_epi8(v, idx);
+  return _mm256_permute2x128_si256(inLane, inLane, 1);
+}
+
+GN_TARGET("avx2") inline int whitespaceMask32(__m256i v) {
+  const __m256i ctl = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('\t' - 1)),
+                                       _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), v));
+  return _mm256_movemask_epi8(_mm256_or_si256(ctl, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '))));
+}
+
+GN_TARGET("avx2") inline unsigned gapMask32(__m256i v, bool caseInsensitive) {
+  const __m256i folded = caseInsensitive ? _mm256_or_si256(v, _mm256_set1_epi8(0x20)) : v;
+  return static_cast<unsigned>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8(caseInsensitive ? 'n' : 'N'))));
+}
+
+GN_TARGET("avx2") void rcIntoAvx2(const char* in, std::size_t n, char* out) {
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + n - i - 32));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), complement32(reverse32(v)));
+  }
+  rcIntoScalar(in, n - i, out + i);
+}
+
+GN_TARGET("avx2") void rcInPlaceAvx2(char* seq, std::size_t n) {
+  std::size_t lo = 0;
+  std::size_t hi = n;
+  while (hi - lo >= 64) {
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(seq + lo));
+    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(seq + hi - 32));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(seq + lo), complement32(reverse32(b)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(seq + hi - 32), complement32(reverse32(a)));
+    lo += 32;
+    hi -= 32;
+  }
+  rcInPlaceScalar(seq + lo, hi - lo);
+}
+
+GN_TARGET("avx2") void upperIntoAvx2(const char* in, std::size_t n, char* out) {
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), upper32(v));
+  }
+  upperIntoScalar(in + i, n - i, out + i);
+}
+
+GN_TARGET("avx2") std::size_t stripAvx2(const char* in, std::size_t n, char* out) {
+  std::size_t i = 0;
+  std::size_t w = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    if (whitespaceMask32(v) == 0) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + w), upper32(v));
+      w += 32;
+    } else {
+      w += stripScalar(in + i, 32, out + w);
+    }
+  }
+  return w + stripScalar(in + i, n - i, out + w);
+}
+
+GN_TARGET("avx2") std::size_t findGapAvx2(const char* in, std::size_t n, bool caseInsensitive) {
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const unsigned mask = gapMask32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), caseInsensitive);
+    if (mask != 0) return i + lowestSetBit(mask);
+  }
+  return i + findGapScalar(in + i, n - i, caseInsensitive);
+}
+
+GN_TARGET("avx2") std::size_t gapRunAvx2(const char* in, std::size_t n, bool caseInsensitive) {
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const unsigned mask = ~gapMask32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), caseInsensitive);
+    if (mask != 0) return i + lowestSetBit(mask);
+  }
+  return i + gapRunScalar(in + i, n - i, caseInsensitive);
+}
+
+GN_TARGET("avx2") std::size_t findPatternPairAvx2(const char* in, std::size_t n, const char* first,
+                                                   const char* second, std::size_t m) {
+  const std::size_t mid = m > 1 ? 1 : 0;
+  const __m256i f0 = _mm256_set1_epi8(first[0]);
+  const __m256i f1 = _mm256_set1_epi8(first[mid]);
+  const __m256i f2 = _mm256_set1_epi8(first[m - 1]);
+  const __m256i s0 = _mm256_set1_epi8(second[0]);
+  const __m256i s1 = _mm256_set1_epi8(second[mid]);
+  const __m256i s2 = _mm256_set1_epi8(second[m - 1]);
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + mid));
+    const __m256i b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + m - 1));
+    const __m256i hitFirst = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(b0, f0), _mm256_cmpeq_epi8(b1, f1)),
+                                              _mm256_cmpeq_epi8(b2, f2));
+    const __m256i hitSecond = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(b0, s0), _mm256_cmpeq_epi8(b1, s1)),
+                                               _mm256_cmpeq_epi8(b2, s2));
+    for (unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(hitFirst, hitSecond)));
+         mask != 0; mask &= mask - 1) {
+      const std::size_t at = i + lowestSetBit(mask);
+      if (matchesEither(in + at, first, second, m)) return at;
+    }
+  }
+  return i + findPatternPairScalar(in + i, n - i, first, second, m);
+}
+
+enum class Isa { Scalar, Sse41, Avx2 };
+
+Isa detectIsa() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4] = {0, 0, 0, 0};
+  __cpuid(info, 0);
+  const int maxLeaf = info[0];
+  __cpuid(info, 1);
+  const bool sse41 = (info[2] & (1 << 19)) != 0;
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  bool avx2 = false;
+  if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+    __cpuidex(info, 7, 0);
+    avx2 = (info[1] & (1 << 5)) != 0;
+  }
+  return avx2 ? Isa::Avx2 : (sse41 ? Isa::Sse41 : Isa::Scalar);
+#else
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return Isa::Avx2;
+  if (__builtin_cpu_supports("sse4.1")) return Isa::Sse41;
+  return Isa::Scalar;
+#endif
+}
+
+#endif  // GN_SEQ_X86
+
+struct KernelTable {
+  void (*rcInto)(const char*, std::size_t, char*);
+  void (*rcInPlace)(char*, std::size_t);
+  void (*upperInto)(const char*, std::size_t, char*);
+  std::size_t (*strip)(const char*, std::size_t, char*);
+  std::size_t (*findGap)(const char*, std::size_t, bool);
+  std::size_t (*gapRun)(const char*, std::size_t, bool);
+  std::size_t (*findPatternPair)(const char*, std::size_t, const char*, const char*, std::size_t);
+  const char* isa;
+};
+
+KernelTable selectKernels() {
+#if GN_SEQ_X86
+  switch (detectIsa()) {
+    case Isa::Avx2:
+      return {rcIntoAvx2, rcInPlaceAvx2, upperIntoAvx2, stripAvx2, findGapAvx2, gapRunAvx2, findPatternPairAvx2, "avx2"};
+    case Isa::Sse41:
+      return {rcIntoSse41, rcInPlaceSse41, upperIntoSse41, stripSse41, findGapSse41, gapRunSse41, findPatternPairSse41, "sse4.1"};
+    case Isa::Scalar:
+      break;
+  }
+#endif
+  return {rcIntoScalar, rcInPlaceScalar, upperIntoScalar, stripScalar, findGapScalar, gapRunScalar, findPatternPairScalar, "scalar"};
+}
+
+const KernelTable& kernels() {
+  static const KernelTable table = selectKernels();
+  return table;
+}
+
+}  // namespace
+
+void reverseComplementInto(const char* in, std::size_t n, char* out) {
+  kernels().rcInto(in, n, out);
+}
+
+void reverseComplementInPlace(char* seq, std::size_t n) {
+  kernels().rcInPlace(seq, n);
+}
+
+void toUpperInto(const char* in, std::size_t n, char* out) {
+  kernels().upperInto(in, n, out);
+}
+
+void toUpperInPlace(char* seq, std::size_t n) {
+  kernels().upperInto(seq, n, seq);
+}
+
+std::size_t copyUpperStripWhitespace(const char* in, std::size_t n, char* out) {
+  return kernels().strip(in, n, out);
+}
+
+std::size_t findGapBase(const char* in, std::size_t n, bool caseInsensitive) {
+  return kernels().findGap(in, n, caseInsensitive);
+}
+
+std::size_t gapRunLength(const char* in, std::size_t n, bool caseInsensitive) {
+  return kernels().gapRun(in, n, caseInsensitive);
+}
+
+std::size_t findPatternPair(const char* in, std::size_t n, const char* first, const char* second, std::size_t m) {
+  return kernels().findPatternPair(in, n, first, second, m);
+}
+
+const char* seqKernelIsa() {
+  return kernels().isa;
+}
+
+}  // namespace gapneedle
+
+extern "C" void gn_seq_reverse_complement_inplace(char* seq, size_t n) {
+  gapneedle::reverseComplementInPlace(seq, n);
+}
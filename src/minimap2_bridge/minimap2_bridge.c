@@ -1,5 +1,7 @@
 #include "minimap2_bridge.h"
 
+#include "gapneedle/seq_kernels.h"
+
 #include <errno.h>
 #include <ctype.h>
 #include <fcntl.h>
@@ -174,40 +176,9 @@ static int gn_write_single_fasta(const char* path, const char* name, const char*
   return 0;
 }
 
-static char gn_comp_base(char c) {
-  switch ((unsigned char)toupper((unsigned char)c)) {
-    case 'A': return 'T';
-    case 'T': return 'A';
-    case 'C': return 'G';
-    case 'G': return 'C';
-    case 'U': return 'A';
-    case 'R': return 'Y';
-    case 'Y': return 'R';
-    case 'S': return 'S';
-    case 'W': return 'W';
-    case 'K': return 'M';
-    case 'M': return 'K';
-    case 'B': return 'V';
-    case 'D': return 'H';
-    case 'H': return 'D';
-    case 'V': return 'B';
-    default: return 'N';
-  }
-}
-
 static void gn_reverse_complement_inplace(gn_str_t* seq) {
   if (!seq || !seq->s || seq->n == 0) return;
-  size_t i = 0;
-  size_t j = seq->n - 1;
-  while (i < j) {
-    const char li = seq->s[i];
-    const char rj = seq->s[j];
-    seq->s[i] = gn_comp_base(rj);
-    seq->s[j] = gn_comp_base(li);
-    ++i;
-    --j;
-  }
-  if (i == j) seq->s[i] = gn_comp_base(seq->s[i]);
+  gn_seq_reverse_complement_inplace(seq->s, seq->n);
 }
 
 static void gn_free_regs(mm_reg1_t* regs, int n_regs) {
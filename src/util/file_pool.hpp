@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+
+namespace gapneedle {
+
+// Identifies one version of a FASTA on disk: canonical path, size and mtime.
+struct FileVersion {
+  std::string path;
+  std::uintmax_t size{0};
+  std::filesystem::file_time_type mtime{};
+
+  static FileVersion of(const std::string& fastaPath) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    FileVersion v;
+    const fs::path canonical = fs::weakly_canonical(fs::path(fastaPath), ec);
+    v.path = ec ? fastaPath : canonical.string();
+    v.size = fs::file_size(fastaPath, ec);
+    if (ec) {
+      throw std::runtime_error("Failed to open FASTA: " + fastaPath);
+    }
+    v.mtime = fs::last_write_time(fastaPath, ec);
+    return v;
+  }
+
+  bool operator==(const FileVersion& o) const { return path == o.path && size == o.size && mtime == o.mtime; }
+};
+
+// Process-wide LRU of shared objects built from a FASTA (readers, indexes), keyed by the file's
+// version plus a `Variant` for objects that differ by options. When a file changes on disk, its
+// entries for older versions are dropped on the next acquire.
+template <typename Value, typename Variant = std::monostate>
+class FilePool {
+ public:
+  explicit FilePool(std::size_t capacity) : capacity_(capacity) {}
+
+  // Returns the pooled object, or one built by `make()`. Built outside the lock so a slow first
+  // build does not block lookups of other files; if another thread won the race, its object is
+  // shared instead.
+  template <typename Make>
+  std::shared_ptr<const Value> acquire(const FileVersion& version, const Variant& variant, Make&& make) {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (auto hit = findLocked(version, variant)) {
+        return hit;
+      }
+    }
+
+    std::shared_ptr<const Value> value = make();
+
+    std::lock_guard<std::mutex> lock(mu_);
+    if (auto hit = findLocked(version, variant)) {
+      return hit;
+    }
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      const bool stale = it->version.path == version.path && it->variant == variant;
+      it = stale ? entries_.erase(it) : std::next(it);
+    }
+    entries_.push_front(Entry{version, variant, value});
+    trimLocked();
+    return value;
+  }
+
+  void setCapacity(std::size_t capacity) {
+    std::lock_guard<std::mutex> lock(mu_);
+    capacity_ = std::max<std::size_t>(1, capacity);
+    trimLocked();
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mu_);
+    entries_.clear();
+  }
+
+ private:
+  struct Entry {
+    FileVersion version;
+    Variant variant;
+    std::shared_ptr<const Value> value;
+  };
+
+  std::shared_ptr<const Value> findLocked(const FileVersion& version, const Variant& variant) {
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->version == version && it->variant == variant) {
+        entries_.splice(entries_.begin(), entries_, it);
+        return entries_.front().value;
+      }
+    }
+    return nullptr;
+  }
+
+  void trimLocked() {
+    while (entries_.size() > capacity_) {
+      entries_.pop_back();
+    }
+  }
+
+  std::mutex mu_;
+  std::size_t capacity_;
+  std::list<Entry> entries_;  // most recently used first
+};
+
+}  // namespace gapneedle
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gapneedle {
+
+// Small process-wide FIFO worker set for blocking I/O (async FASTA fetches). Kept separate from
+// compute pools so slow disks never starve CPU-bound work. Workers start on first use; tasks
+// still queued at process exit are drained before the workers join.
+class IoExecutor {
+ public:
+  static IoExecutor& instance();
+
+  explicit IoExecutor(unsigned threads);
+  ~IoExecutor();
+  IoExecutor(const IoExecutor&) = delete;
+  IoExecutor& operator=(const IoExecutor&) = delete;
+
+  // Tasks must not throw; wrap failures into their own completion channel.
+  void submit(std::function<void()> task);
+
+ private:
+  void run();
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> queue_;
+  std::vector<std::thread> workers_;
+  bool stopping_{false};
+};
+
+}  // namespace gapneedle
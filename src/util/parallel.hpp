@@ -0,0 +1,54 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gapneedle {
+
+inline unsigned defaultThreadCount() {
+  const unsigned hw = std::thread::hardware_concurrency();
+  return hw == 0 ? 4 : hw;
+}
+
+// Runs fn(i) for every i in [0, n) on up to `threads` workers (0 = hardware concurrency).
+// Tasks are handed out dynamically, so uneven work (e.g. one chromosome per task) balances.
+// The first exception thrown by a task is rethrown on the calling thread after all workers stop.
+template <typename Fn>
+void parallelFor(std::size_t n, unsigned threads, Fn&& fn) {
+  if (n == 0) return;
+  const std::size_t workers = std::min<std::size_t>(n, threads == 0 ? defaultThreadCount() : threads);
+  if (workers <= 1) {
+    for (std::size_t i = 0; i < n; ++i) fn(i);
+    return;
+  }
+
+  std::atomic<std::size_t> next{0};
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+  std::mutex errorMu;
+  auto run = [&]() {
+    for (std::size_t i = next++; i < n && !failed; i = next++) {
+      try {
+        fn(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMu);
+        if (!error) error = std::current_exception();
+        failed = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(workers - 1);
+  for (std::size_t t = 1; t < workers; ++t) pool.emplace_back(run);
+  run();
+  for (auto& th : pool) th.join();
+  if (error) std::rethrow_exception(error);
+}
+
+}  // namespace gapneedle
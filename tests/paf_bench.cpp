@@ -0,0 +1,129 @@
+// Throughput of parsePaf against the original getline/stringstream parser on a synthetic
+// all-vs-all PAF. Usage: gapneedle_paf_bench [lines] [pafPath]
+#include "gapneedle/paf.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The parser parsePaf replaced, kept as the baseline.
+std::vector<gapneedle::AlignmentRecord> parsePafStream(const std::string& path,
+                                                       const std::string& targetSeq,
+                                                       const std::string& querySeq) {
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("Failed to open PAF: " + path);
+  }
+  std::vector<gapneedle::AlignmentRecord> out;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    std::vector<std::string> parts;
+    std::stringstream ss(line);
+    std::string item;
+    while (std::getline(ss, item, '\t')) {
+      parts.push_back(item);
+    }
+    if (parts.size() < 12 || parts[0] != querySeq || parts[5] != targetSeq) {
+      continue;
+    }
+    gapneedle::AlignmentRecord r;
+    r.qName = parts[0];
+    r.qLen = std::stoll(parts[1]);
+    r.qStart = std::stoll(parts[2]);
+    r.qEnd = std::stoll(parts[3]);
+    r.strand = parts[4].empty() ? '+' : parts[4][0];
+    r.tName = parts[5];
+    r.tLen = std::stoll(parts[6]);
+    r.tStart = std::stoll(parts[7]);
+    r.tEnd = std::stoll(parts[8]);
+    r.matches = std::stoll(parts[9]);
+    r.alnLen = std::stoll(parts[10]);
+    r.mapq = std::stoi(parts[11]);
+    for (std::size_t i = 12; i < parts.size(); ++i) {
+      r.extras.push_back(parts[i]);
+    }
+    out.push_back(std::move(r));
+  }
+  return out;
+}
+
+void writeSyntheticPaf(const std::string& path, std::size_t lines) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Failed to write PAF: " + path);
+  }
+  unsigned state = 12345u;
+  auto next = [&state]() {
+    state = state * 1103515245u + 12345u;
+    return state >> 8;
+  };
+  for (std::size_t i = 0; i < lines; ++i) {
+    // 40 x 40 contigs, so about one line in 1600 belongs to the benchmarked pair.
+    const unsigned q = next() % 40;
+    const unsigned t = next() % 40;
+    const long long qLen = 20000000 + next() % 80000000;
+    const long long tLen = 20000000 + next() % 80000000;
+    const long long qStart = next() % (qLen / 2);
+    const long long tStart = next() % (tLen / 2);
+    const long long span = 1000 + next() % 50000;
+    out << "ctg" << q << "\t" << qLen << "\t" << qStart << "\t" << qStart + span << "\t" << ((next() & 1) ? '+' : '-')
+        << "\tctg" << t << "\t" << tLen << "\t" << tStart << "\t" << tStart + span << "\t" << span - next() % 500
+        << "\t" << span << "\t" << next() % 61 << "\ttp:A:P\tcm:i:" << next() % 5000 << "\ts1:i:" << next() % 50000
+        << "\tdv:f:0." << next() % 1000 << "\tcg:Z:" << span / 2 << "M10I" << span / 2 - 10 << "M\n";
+  }
+}
+
+template <typename Fn>
+double secondsOf(const Fn& fn) {
+  const auto t0 = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t lines = argc > 1 ? static_cast<std::size_t>(std::stoull(argv[1])) : 2000000;
+  const std::string path = argc > 2 ? argv[2] : "gapneedle_paf_bench.paf";
+  try {
+    writeSyntheticPaf(path, lines);
+    std::ifstream probe(path, std::ios::binary | std::ios::ate);
+    const double mb = static_cast<double>(probe.tellg()) / (1024.0 * 1024.0);
+
+    std::vector<gapneedle::AlignmentRecord> baseline;
+    std::vector<gapneedle::AlignmentRecord> mapped;
+    // Warm the page cache so both parsers read from memory.
+    gapneedle::parsePaf(path, "ctg1", "ctg0");
+    const double tStream = secondsOf([&] { baseline = parsePafStream(path, "ctg1", "ctg0"); });
+    const double tMapped = secondsOf([&] { mapped = gapneedle::parsePaf(path, "ctg1", "ctg0"); });
+
+    bool same = baseline.size() == mapped.size();
+    for (std::size_t i = 0; same && i < mapped.size(); ++i) {
+      const auto& a = baseline[i];
+      const auto& b = mapped[i];
+      same = a.qName == b.qName && a.tName == b.tName && a.qStart == b.qStart && a.qEnd == b.qEnd &&
+             a.tStart == b.tStart && a.tEnd == b.tEnd && a.matches == b.matches && a.mapq == b.mapq &&
+             a.strand == b.strand && a.extras == b.extras;
+    }
+
+    std::printf("PAF: %zu lines, %.1f MiB, %zu matching records\n", lines, mb, mapped.size());
+    std::printf("stringstream parser: %8.3f s  %8.1f MiB/s\n", tStream, mb / tStream);
+    std::printf("mapped parser:       %8.3f s  %8.1f MiB/s\n", tMapped, mb / tMapped);
+    std::printf("speedup: %.1fx, results %s\n", tStream / tMapped, same ? "identical" : "DIFFER");
+    std::remove(path.c_str());
+    return same ? 0 : 1;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+}
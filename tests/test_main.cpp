@@ -1,13 +1,73 @@
+#include "gapneedle/edit_matcher.hpp"
 #include "gapneedle/fasta_io.hpp"
+#include "gapneedle/fm_index.hpp"
+#include "gapneedle/gap_service.hpp"
 #include "gapneedle/guided_stitch_service.hpp"
 #include "gapneedle/mapping_service.hpp"
+#include "gapneedle/motif_scanner.hpp"
+#include "gapneedle/packed_sequence.hpp"
 #include "gapneedle/paf.hpp"
+#include "gapneedle/search_service.hpp"
+#include "gapneedle/seq_kernels.hpp"
+#include "gapneedle/telomere_service.hpp"
 #include "gapneedle/facade.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cctype>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if GAPNEEDLE_HAS_ZLIB
+#include <zlib.h>
+
+namespace {
+
+// Writes `data` as BGZF (bgzip-compatible) blocks of at most `blockSize` input bytes.
+void writeBgzf(const std::string& path, const std::string& data, std::size_t blockSize) {
+  std::ofstream out(path, std::ios::binary);
+  auto put16 = [&out](unsigned v) {
+    out.put(static_cast<char>(v & 0xff));
+    out.put(static_cast<char>((v >> 8) & 0xff));
+  };
+  auto put32 = [&put16](unsigned long v) {
+    put16(static_cast<unsigned>(v & 0xffff));
+    put16(static_cast<unsigned>((v >> 16) & 0xffff));
+  };
+  auto block = [&](const char* p, std::size_t n) {
+    std::string comp(compressBound(static_cast<uLong>(n)) + 16, '\0');
+    z_stream zs{};
+    deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(p));
+    zs.avail_in = static_cast<uInt>(n);
+    zs.next_out = reinterpret_cast<Bytef*>(comp.data());
+    zs.avail_out = static_cast<uInt>(comp.size());
+    deflate(&zs, Z_FINISH);
+    const std::size_t clen = zs.total_out;
+    deflateEnd(&zs);
+    const char header[] = {'\x1f', '\x8b', '\x08', '\x04', 0, 0, 0, 0, 0, '\xff', 6, 0, 'B', 'C', 2, 0};
+    out.write(header, sizeof(header));
+    put16(static_cast<unsigned>(clen + 25));
+    out.write(comp.data(), static_cast<std::streamsize>(clen));
+    put32(crc32(0, reinterpret_cast<const Bytef*>(p), static_cast<uInt>(n)));
+    put32(static_cast<unsigned long>(n));
+  };
+  for (std::size_t i = 0; i < data.size(); i += blockSize) {
+    block(data.data() + i, std::min(blockSize, data.size() - i));
+  }
+  block(nullptr, 0);
+}
+
+}  // namespace
+#endif
 
 int main() {
   {
@@ -16,6 +76,1177 @@ int main() {
     assert(rc == "NACGT");
   }
 
+  {
+    // Vector kernels must agree with a byte-at-a-time reference on every length and alphabet.
+    const std::string alphabet = "ACGTacgtNnRYkm-*\t \r\n\x80\xff";
+    std::string raw;
+    unsigned state = 12345u;
+    for (int i = 0; i < 1000; ++i) {
+      state = state * 1103515245u + 12345u;
+      raw.push_back(alphabet[(state >> 16) % alphabet.size()]);
+    }
+    auto upper = [](char c) { return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 32) : c; };
+    auto comp = [&](char c) {
+      switch (upper(c)) {
+        case 'A': return 'T';
+        case 'C': return 'G';
+        case 'G': return 'C';
+        case 'T': return 'A';
+        default: return 'N';
+      }
+    };
+    for (std::size_t n : {0u, 1u, 15u, 16u, 31u, 32u, 33u, 63u, 64u, 65u, 127u, 1000u}) {
+      const std::string in = raw.substr(0, n);
+      std::string expectRc;
+      std::string expectUpper;
+      std::string expectStripped;
+      for (std::size_t i = 0; i < n; ++i) {
+        expectRc.push_back(comp(in[n - 1 - i]));
+        expectUpper.push_back(upper(in[i]));
+        if (!std::isspace(static_cast<unsigned char>(in[i]))) expectStripped.push_back(upper(in[i]));
+      }
+      assert(gapneedle::reverseComplement(in) == expectRc);
+      std::string inPlace = in;
+      gapneedle::reverseComplementInPlace(inPlace.data(), inPlace.size());
+      assert(inPlace == expectRc);
+      std::string up = in;
+      gapneedle::toUpperInPlace(up.data(), up.size());
+      assert(up == expectUpper);
+      std::string stripped(n, '\0');
+      stripped.resize(gapneedle::copyUpperStripWhitespace(in.data(), n, stripped.data()));
+      assert(stripped == expectStripped);
+      for (const bool ci : {true, false}) {
+        auto isGap = [ci](char c) { return c == 'N' || (ci && c == 'n'); };
+        const std::size_t firstGap = static_cast<std::size_t>(std::find_if(in.begin(), in.end(), isGap) - in.begin());
+        assert(gapneedle::findGapBase(in.data(), n, ci) == firstGap);
+        const std::string run = std::string(n / 2, ci ? 'n' : 'N') + in;
+        const std::size_t runLen = static_cast<std::size_t>(
+            std::find_if_not(run.begin(), run.end(), isGap) - run.begin());
+        assert(gapneedle::gapRunLength(run.data(), run.size(), ci) == runLen);
+      }
+    }
+    for (const std::string& pattern : {std::string("A"), std::string("Ac"), std::string("NnR"), std::string("ACGTacgtNn")}) {
+      const std::string other = std::string(pattern.rbegin(), pattern.rend());
+      const std::size_t n = raw.size() - pattern.size() + 1;
+      for (std::size_t from = 0; from < 64; from += 7) {
+        std::size_t expect = n - from;
+        for (std::size_t i = from; i < n; ++i) {
+          if (raw.compare(i, pattern.size(), pattern) == 0 || raw.compare(i, other.size(), other) == 0) {
+            expect = i - from;
+            break;
+          }
+        }
+        assert(gapneedle::findPatternPair(raw.data() + from, n - from, pattern.data(), other.data(), pattern.size()) ==
+               expect);
+      }
+    }
+    const std::string isa = gapneedle::seqKernelIsa();
+    assert(isa == "avx2" || isa == "sse4.1" || isa == "scalar");
+  }
+
+  {
+    const std::string fastaPath = "/tmp/gapneedle_indexed_test.fa";
+    {
+      std::ofstream fa(fastaPath, std::ios::binary);
+      fa << ">s1 desc\nACGTacgtAC\nGTACGTACGT\nAAC\n>s2\nNNNNnnnnGG\nTT\n";
+    }
+    std::filesystem::remove(fastaPath + ".fai");
+
+    gapneedle::FastaIndexedReader reader(fastaPath);
+    assert(reader.length("s1") == 23);
+    assert(reader.length("s2") == 12);
+    assert(reader.fetch("s1", 0, 23) == "ACGTACGTACGTACGTACGTAAC");
+    assert(reader.fetch("s1", 8, 12) == "ACGT");
+    assert(reader.fetch("s2", 6, 100) == "NNGGTT");
+    assert(reader.fetch("s2", 5, 5).empty());
+
+    char buf[8] = {0};
+    assert(reader.fetchInto("s1", 18, 23, buf) == 5);
+    assert(std::string(buf, 5) == "GTAAC");
+
+    std::string raw;
+    int pieces = 0;
+    reader.visit("s2", 2, 11, [&](std::string_view piece) {
+      raw.append(piece);
+      ++pieces;
+    });
+    assert(raw == "NNnnnnGGT");
+    assert(pieces == 2);
+
+    gapneedle::FastaReaderOptions preadOpts;
+    preadOpts.useMmap = false;
+    const gapneedle::FastaIndexedReader preadReader(fastaPath, preadOpts);
+    std::vector<std::thread> workers;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t < 4; ++t) {
+      workers.emplace_back([&preadReader, &mismatches]() {
+        for (int i = 0; i < 200; ++i) {
+          if (preadReader.fetch("s1", 7, 21) != "TACGTACGTACGTA") ++mismatches;
+        }
+      });
+    }
+    for (auto& w : workers) w.join();
+    assert(mismatches == 0);
+
+    auto pooledA = gapneedle::acquireFastaReader(fastaPath);
+    auto pooledB = gapneedle::acquireFastaReader(fastaPath);
+    assert(pooledA == pooledB);
+    assert(gapneedle::readFastaSliceIndexed(fastaPath, "s2", 8, 12) == "GGTT");
+    gapneedle::clearFastaReaderPool();
+    assert(gapneedle::acquireFastaReader(fastaPath) != pooledA);
+  }
+
+  {
+    // fetchMany must match individual fetches whatever the order, overlap or strand of the requests.
+    const std::string fastaPath = "/tmp/gapneedle_fetch_many_test.fa";
+    {
+      std::ofstream fa(fastaPath, std::ios::binary);
+      for (int r = 0; r < 3; ++r) {
+        fa << ">c" << r << "\n";
+        for (int i = 0; i < 5000; ++i) {
+          fa << "ACGTTGCAac"[(i * 7 + r) % 10];
+          if (i % 60 == 59) fa << '\n';
+        }
+        fa << '\n';
+      }
+    }
+    std::filesystem::remove(fastaPath + ".fai");
+    for (const bool useMmap : {true, false}) {
+      gapneedle::FastaReaderOptions opts;
+      opts.useMmap = useMmap;
+      const gapneedle::FastaIndexedReader reader(fastaPath, opts);
+      const std::vector<gapneedle::FastaRegion> regions = {
+          {"c2", 4900, 5100, false}, {"c0", 10, 70, false},   {"c0", 0, 100, true},  {"c1", 100, 100, false},
+          {"c0", 50, 4000, false},  {"c1", 2500, 2600, true}, {"c2", -5, 30, false}, {"c0", 10, 70, false},
+      };
+      const std::vector<std::string> got = reader.fetchMany(regions);
+      assert(got.size() == regions.size());
+      for (std::size_t i = 0; i < regions.size(); ++i) {
+        const auto& r = regions[i];
+        const gapneedle::SeqPos len = reader.length(r.seqName);
+        const gapneedle::SeqPos s = std::max<gapneedle::SeqPos>(0, r.start);
+        const gapneedle::SeqPos e = std::min(r.end, len);
+        const std::string expect = r.reverse
+                                       ? gapneedle::reverseComplement(reader.fetch(r.seqName, len - e, len - s))
+                                       : reader.fetch(r.seqName, s, e);
+        assert(got[i] == expect);
+      }
+      assert(got[3].empty());
+      assert(got[6].size() == 30);
+    }
+
+    // Small blocks so fetches straddle several of them; a tiny budget forces evictions.
+    gapneedle::FastaReaderOptions cached;
+    cached.blockCacheBlockBases = 100;
+    cached.blockCacheBytes = 1000;
+    const gapneedle::FastaIndexedReader cachedReader(fastaPath, cached);
+    gapneedle::FastaReaderOptions uncached;
+    uncached.blockCacheBytes = 0;
+    const gapneedle::FastaIndexedReader plainReader(fastaPath, uncached);
+    assert(cachedReader.fetch("c1", 150, 260) == plainReader.fetch("c1", 150, 260));
+    auto stats = cachedReader.blockCacheStats();
+    assert(stats.misses == 2 && stats.hits == 0 && stats.blocks == 2 && stats.bytes == 200);
+    assert(cachedReader.fetch("c1", 180, 200) == plainReader.fetch("c1", 180, 200));
+    assert(cachedReader.blockCacheStats().hits == 1);
+    assert(cachedReader.fetch("c2", 4950, 5000) == plainReader.fetch("c2", 4950, 5000));
+    for (int b = 0; b < 20; ++b) {
+      assert(cachedReader.fetch("c0", b * 100 + 10, b * 100 + 90) == plainReader.fetch("c0", b * 100 + 10, b * 100 + 90));
+    }
+    stats = cachedReader.blockCacheStats();
+    assert(stats.blocks == 10 && stats.bytes <= 1000);
+    assert(cachedReader.fetch("c0", 0, 5000) == plainReader.fetch("c0", 0, 5000));  // bypasses the cache
+    assert(cachedReader.blockCacheStats().misses == stats.misses);
+    assert(plainReader.blockCacheStats().misses == 0);
+
+    // Async fetches resolve to the same bases as fetch(region), errors included.
+    const gapneedle::FastaIndexedReader asyncReader(fastaPath);
+    asyncReader.prefetch({{"c0", 0, 5000, false}, {"missing", 0, 10, false}});
+    std::vector<std::future<std::string>> pending;
+    for (int i = 0; i < 16; ++i) {
+      pending.push_back(asyncReader.fetchAsync({"c1", i * 300, i * 300 + 250, (i % 2) == 1}));
+    }
+    for (int i = 0; i < 16; ++i) {
+      assert(pending[i].get() == asyncReader.fetch({"c1", i * 300, i * 300 + 250, (i % 2) == 1}));
+    }
+    assert(asyncReader.fetch({"c1", 0, 10, true}) ==
+           gapneedle::reverseComplement(asyncReader.fetch("c1", 4990, 5000)));
+    std::promise<bool> failed;
+    asyncReader.fetchAsync({"missing", 0, 10, false}, [&failed](std::string, std::exception_ptr error) {
+      failed.set_value(error != nullptr);
+    });
+    assert(failed.get_future().get());
+    auto missing = asyncReader.fetchAsync({"missing", 0, 10, false});
+    bool asyncThrew = false;
+    try {
+      missing.get();
+    } catch (const std::runtime_error&) {
+      asyncThrew = true;
+    }
+    assert(asyncThrew);
+
+    bool threw = false;
+    try {
+      gapneedle::FastaIndexedReader(fastaPath).fetchMany({{"missing", 0, 10, false}});
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+
+  {
+    const std::string raw = "acgtNNNNNRYacgtacgtttGGNN";
+    gapneedle::PackedSequence packed(raw);
+    assert(packed.size() == raw.size());
+    assert(packed.decode() == "ACGTNNNNNRYACGTACGTTTGGNN");
+    assert(packed.decode(3, 12) == "TNNNNNRYA");
+    assert(packed.at(9) == 'R');
+    assert(packed.ambiguityRuns().size() == 4);
+
+    const std::string fastaPath = "/tmp/gapneedle_packed_test.fa";
+    {
+      std::ofstream fa(fastaPath);
+      fa << ">g1\nACGTNNNNNNNNNNNNACG\nTNNN\n>g2 x\nacgtnnnnnnnnnnnnnnnn\n";
+    }
+    const auto records = gapneedle::readFastaPacked(fastaPath);
+    assert(records.at("g1").decode() == "ACGTNNNNNNNNNNNNACGTNNN");
+    assert(records.at("g2").size() == 20);
+
+    gapneedle::GapNeedleFacade facade;
+    auto gaps = facade.scanGaps(fastaPath, 10);
+    std::sort(gaps.begin(), gaps.end());
+    assert(gaps.size() == 2);
+    assert(gaps[0] == std::make_tuple(std::string("g1"), 4, 16));
+    assert(gaps[1] == std::make_tuple(std::string("g2"), 4, 20));
+
+    gapneedle::StitchRequest req;
+    req.targetFasta = fastaPath;
+    req.queryFasta = fastaPath;
+    req.outputFastaPath = "/tmp/gapneedle_packed_stitch.fa";
+    req.segments.push_back(gapneedle::Segment{"t", "g1", 0, 4, false});
+    req.segments.push_back(gapneedle::Segment{"q", "g1", 0, 7, true});
+    auto stitched = facade.stitch(req);
+    assert(stitched.mergedLength == 11);
+    assert(gapneedle::readFasta(req.outputFastaPath).at("stitched") == "ACGTNNNACGT");
+  }
+
+  {
+    // Chunked parallel search must equal a plain find() on both strands, including a hit that
+    // straddles the internal chunk boundary at 8 Mbp and matches split across FASTA lines.
+    const std::string fastaPath = "/tmp/gapneedle_search_test.fa";
+    const std::string query = "GATTACAGG";
+    const std::string queryRc = gapneedle::reverseComplement(query);
+    std::vector<std::pair<std::string, std::string>> records = {{"a", ""}, {"b", ""}, {"empty", ""}};
+    unsigned state = 4242u;
+    for (auto* rec : {&records[0], &records[1]}) {
+      const std::size_t len = rec == &records[0] ? (std::size_t{8} << 20) + 1000 : 5000;
+      rec->second.resize(len);
+      for (auto& c : rec->second) {
+        state = state * 1103515245u + 12345u;
+        c = "ACGT"[(state >> 16) & 3];
+      }
+    }
+    records[0].second.replace((std::size_t{8} << 20) - 3, query.size(), query);
+    records[0].second.replace(100, query.size(), queryRc);
+    records[1].second.replace(4990, query.size(), "gattacagg");
+    {
+      std::ofstream fa(fastaPath, std::ios::binary);
+      for (const auto& [name, seq] : records) {
+        fa << '>' << name << '\n';
+        for (std::size_t i = 0; i < seq.size(); i += 60) fa << seq.substr(i, 60) << '\n';
+      }
+    }
+    std::filesystem::remove(fastaPath + ".fai");
+
+    std::vector<gapneedle::SearchHit> expect;
+    for (const auto& [name, seq] : records) {
+      std::string upper = seq;
+      gapneedle::toUpperInPlace(upper.data(), upper.size());
+      for (std::size_t pos = 0; pos + query.size() <= upper.size(); ++pos) {
+        for (const bool rev : {false, true}) {
+          if (upper.compare(pos, query.size(), rev ? queryRc : query) == 0) {
+            const auto start = static_cast<gapneedle::SeqPos>(pos);
+            expect.push_back({name, start, start + static_cast<gapneedle::SeqPos>(query.size()), rev});
+          }
+        }
+      }
+    }
+    assert(expect.size() >= 3);
+    auto same = [](const std::vector<gapneedle::SearchHit>& a, const std::vector<gapneedle::SearchHit>& b) {
+      if (a.size() != b.size()) return false;
+      for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].seqName != b[i].seqName || a[i].start != b[i].start || a[i].end != b[i].end ||
+            a[i].reverse != b[i].reverse) {
+          return false;
+        }
+      }
+      return true;
+    };
+
+    gapneedle::SearchOptions options;
+    options.threads = 3;
+    options.batchHits = 1;
+    std::size_t batches = 0;
+    std::vector<gapneedle::SearchHit> streamed;
+    gapneedle::GapNeedleFacade().search(fastaPath, "gattacagg", options, [&](const std::vector<gapneedle::SearchHit>& batch) {
+      assert(batch.size() == 1);
+      ++batches;
+      streamed.insert(streamed.end(), batch.begin(), batch.end());
+      return true;
+    });
+    assert(batches == expect.size() && same(streamed, expect));
+
+    options.bothStrands = false;
+    std::vector<gapneedle::SearchHit> forward;
+    std::copy_if(expect.begin(), expect.end(), std::back_inserter(forward), [](const auto& h) { return !h.reverse; });
+    assert(same(gapneedle::searchFasta(fastaPath, query, options), forward));
+
+    options.bothStrands = true;
+    options.maxHits = 2;
+    assert(same(gapneedle::searchFasta(fastaPath, query, options), {expect[0], expect[1]}));
+    options.maxHits = 0;
+    std::size_t calls = 0;
+    gapneedle::searchFasta(fastaPath, query, options, [&calls](const std::vector<gapneedle::SearchHit>&) {
+      ++calls;
+      return false;
+    });
+    assert(calls == 1);
+    // A palindromic query is reported once per position.
+    for (const auto& h : gapneedle::searchFasta(fastaPath, "ACGT")) assert(!h.reverse);
+
+    std::ostringstream tsv;
+    gapneedle::writeSearchHits(tsv, {expect.back()});
+    assert(tsv.str() == "b\t4990\t4999\t+\n");
+  }
+
+  {
+    // FM-index lookups must agree with the scan, including repeats, N runs and soft-masked bases.
+    const std::string fastaPath = "/tmp/gapneedle_fm_test.fa";
+    const std::string cacheDir = "/tmp/gapneedle_fm_cache";
+    std::filesystem::remove_all(cacheDir);
+    std::vector<std::pair<std::string, std::string>> records = {
+        {"r1", ""}, {"r2", std::string(300, 'A') + "NNNNN" + std::string(200, 'a')}, {"r3", ""}, {"r4", "ACAC"},
+        {"r5", "ACGT" + std::string(100000, 'N') + "TTGCA"}};
+    unsigned state = 7;
+    for (auto* seq : {&records[0].second, &records[2].second}) {
+      for (int i = 0; i < 20000; ++i) {
+        state = state * 1103515245u + 12345u;
+        *seq += "ACGTacgtNACACACAC"[(state >> 16) % (i % 3000 < 2500 ? 4 : 17)];
+      }
+    }
+    records[2].second += std::string(64, 'C') + "ACACACACACACACACAC";
+    {
+      std::ofstream fa(fastaPath, std::ios::binary);
+      for (const auto& [name, seq] : records) fa << '>' << name << '\n' << seq << '\n';
+    }
+    std::filesystem::remove(fastaPath + ".fai");
+
+    auto same = [](const std::vector<gapneedle::SearchHit>& a, const std::vector<gapneedle::SearchHit>& b) {
+      if (a.size() != b.size()) return false;
+      for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].seqName != b[i].seqName || a[i].start != b[i].start || a[i].end != b[i].end ||
+            a[i].reverse != b[i].reverse) {
+          return false;
+        }
+      }
+      return true;
+    };
+    const std::string indexPath = gapneedle::fmIndexPathOf(fastaPath, cacheDir);
+    assert(indexPath.rfind(cacheDir + "/", 0) == 0 && indexPath.size() > 5 &&
+           indexPath.compare(indexPath.size() - 5, 5, ".gnfm") == 0);
+    const gapneedle::FmIndex built(fastaPath, indexPath);
+    assert(!built.loadedFromFile() && std::filesystem::exists(indexPath));
+    const gapneedle::FmIndex loaded(fastaPath, indexPath);
+    assert(loaded.loadedFromFile());
+    // Rows inside the N run are never located, so they add rank data but no samples.
+    assert(std::filesystem::file_size(indexPath) < 2 * std::filesystem::file_size(fastaPath));
+
+    std::vector<std::string> queries = {"A", "AC", "ACAC", "aaaa", "CCCCCCCC", "ACGTACGT", "TTTTTTTTTTTTTTTTTTTTTTTTT",
+                                        records[0].second.substr(123, 17), records[2].second.substr(19000, 40),
+                                        "TTGCA", "ACGTTTGCA",
+                                        "AAAA" + records[2].second.substr(0, 4)};  // spans r2/r3: never a match
+    for (const auto& query : queries) {
+      for (const bool both : {false, true}) {
+        gapneedle::SearchOptions options;
+        options.bothStrands = both;
+        const auto scanned = gapneedle::searchFasta(fastaPath, query, options);
+        assert(same(loaded.locate(query, both), scanned));
+        if (!both) assert(loaded.count(query) == static_cast<gapneedle::SeqPos>(scanned.size()));
+        options.useIndex = true;
+        options.indexCacheDir = cacheDir;
+        assert(same(gapneedle::searchFasta(fastaPath, query, options), scanned));
+        assert(gapneedle::countFastaHits(fastaPath, query, options) == scanned.size());
+      }
+    }
+    assert(!gapneedle::FmIndex::supports("ACNT") && !gapneedle::FmIndex::supports(""));
+    assert(loaded.count("ACNT") == 0);
+
+    // An index that cannot be written (its directory is a file) is built once and kept in memory.
+    const gapneedle::FmIndex inMemory(fastaPath, fastaPath + "/unwritable.gnfm");
+    assert(!inMemory.loadedFromFile());
+    assert(same(inMemory.locate("ACAC", true), loaded.locate("ACAC", true)));
+
+    // Queries the index cannot answer, and limited searches, still give the scan's results.
+    gapneedle::SearchOptions options;
+    options.useIndex = true;
+    options.indexCacheDir = cacheDir;
+    assert(same(gapneedle::searchFasta(fastaPath, "AANAA", options), gapneedle::searchFasta(fastaPath, "AANAA")));
+    assert(gapneedle::countFastaHits(fastaPath, "AANAA", options) == gapneedle::searchFasta(fastaPath, "AANAA").size());
+    options.maxHits = 3;
+    auto firstThree = gapneedle::searchFasta(fastaPath, "ACAC");
+    firstThree.resize(3);
+    assert(same(gapneedle::searchFasta(fastaPath, "ACAC", options), firstThree));
+    assert(gapneedle::countFastaHits(fastaPath, "ACAC", options) == 3);
+
+    // A raised cancel flag stops the scan before its first chunk and abandons an index build.
+    std::atomic<bool> cancel{true};
+    gapneedle::SearchOptions cancelled;
+    cancelled.cancel = &cancel;
+    assert(gapneedle::searchFasta(fastaPath, "ACAC", cancelled).empty());
+    cancelled.useIndex = true;
+    cancelled.indexCacheDir = cacheDir + "/cancelled";
+    bool threw = false;
+    try {
+      gapneedle::searchFasta(fastaPath, "ACAC", cancelled);
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    assert(threw && !std::filesystem::exists(gapneedle::fmIndexPathOf(fastaPath, cancelled.indexCacheDir)));
+    cancel = false;
+    assert(same(gapneedle::searchFasta(fastaPath, "ACAC", cancelled), gapneedle::searchFasta(fastaPath, "ACAC")));
+
+    // A rewritten FASTA invalidates the file and gets a new one.
+    std::filesystem::last_write_time(fastaPath, std::filesystem::last_write_time(fastaPath) + std::chrono::seconds(5));
+    assert(gapneedle::fmIndexPathOf(fastaPath, cacheDir) != indexPath);
+    assert(!gapneedle::FmIndex(fastaPath, indexPath).loadedFromFile());
+    assert(gapneedle::FmIndex(fastaPath, indexPath).loadedFromFile());
+    gapneedle::clearFmIndexPool();
+  }
+
+  {
+    // Myers' bit vectors (one and several words) must reproduce the textbook edit-distance DP.
+    auto same = [](char a, char b) { return a == b && a != 'N'; };
+    auto distance = [&same](const std::string& p, const std::string& t) {
+      std::vector<std::size_t> row(t.size() + 1);
+      for (std::size_t j = 0; j <= t.size(); ++j) row[j] = j;
+      for (std::size_t i = 1; i <= p.size(); ++i) {
+        std::size_t diag = row[0];
+        row[0] = i;
+        for (std::size_t j = 1; j <= t.size(); ++j) {
+          const std::size_t up = row[j];
+          row[j] = std::min({diag + (same(p[i - 1], t[j - 1]) ? 0 : 1), up + 1, row[j - 1] + 1});
+          diag = up;
+        }
+      }
+      return row[t.size()];
+    };
+    unsigned state = 4242u;
+    auto randomBases = [&state](std::size_t n, const char* alphabet, unsigned size) {
+      std::string out;
+      for (std::size_t i = 0; i < n; ++i) {
+        state = state * 1103515245u + 12345u;
+        out += alphabet[(state >> 16) % size];
+      }
+      return out;
+    };
+    for (const auto& [m, k] : std::vector<std::pair<std::size_t, unsigned>>{{10, 2}, {64, 4}, {70, 5}, {130, 8}}) {
+      const std::string pattern = randomBases(m, "ACGT", 4);
+      std::string text = randomBases(500, "ACGTN", 5);
+      for (int copy = 0; copy < 6; ++copy) {
+        std::string mutated = pattern;
+        for (unsigned e = 0; e < (copy % 3) * k / 2; ++e) {
+          const std::size_t at = (state = state * 1103515245u + 12345u) >> 16;
+          const std::size_t pos = at % mutated.size();
+          if (at % 3 == 0) mutated.erase(pos, 1);
+          else if (at % 3 == 1) mutated.insert(pos, 1, "ACGT"[at % 4]);
+          else mutated[pos] = "ACGT"[(at / 3) % 4];
+        }
+        text += mutated + randomBases(50 + copy * 37, "ACGT", 4);
+      }
+
+      // Column minima of the free-start DP, then the local-minimum rule described in the header.
+      std::vector<std::size_t> column(text.size() + 1, m);
+      std::vector<std::size_t> row(text.size() + 1, 0);
+      for (std::size_t i = 1; i <= m; ++i) {
+        std::size_t diag = row[0];
+        row[0] = i;
+        for (std::size_t j = 1; j <= text.size(); ++j) {
+          const std::size_t up = row[j];
+          row[j] = std::min({diag + (same(pattern[i - 1], text[j - 1]) ? 0 : 1), up + 1, row[j - 1] + 1});
+          diag = up;
+        }
+      }
+      const auto sat = [&](std::size_t e) { return e > text.size() ? k + 1 : std::min<std::size_t>(row[e], k + 1); };
+      std::vector<std::pair<std::size_t, unsigned>> expect;
+      for (std::size_t e = 1; e <= text.size(); ++e) {
+        if (sat(e) <= k && sat(e) < sat(e - 1) && sat(e) <= sat(e + 1)) expect.emplace_back(e, static_cast<unsigned>(sat(e)));
+      }
+      assert(expect.size() >= 4);
+
+      const gapneedle::EditMatcher matcher(pattern, k);
+      std::vector<std::pair<std::size_t, unsigned>> got;
+      matcher.scan(text.data(), text.size(), 0, text.size(), [&](std::size_t end, unsigned edits) {
+        got.emplace_back(end, edits);
+        const std::size_t start = matcher.alignStart(text.data(), end);
+        assert(distance(pattern, text.substr(start, end - start)) == edits);
+      });
+      assert(got == expect);
+      got.clear();
+      const std::size_t from = expect[1].first;
+      const std::size_t to = expect[2].first;
+      matcher.scan(text.data(), text.size(), from, to, [&](std::size_t end, unsigned edits) { got.emplace_back(end, edits); });
+      assert(got.front() == expect[1] && got.back() == expect[2]);
+    }
+
+    bool threw = false;
+    try {
+      gapneedle::EditMatcher("ACG", 3);
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+
+  {
+    // Approximate search, seeded or not, must find what one matcher run over each whole sequence
+    // finds, including an occurrence across the 8 Mbp chunk boundary.
+    const std::string fastaPath = "/tmp/gapneedle_approx_search_test.fa";
+    const std::string query = "GATTACAGGCATTCAGGACTTTAGCCGATAGGCTCAATGC";
+    const std::string queryRc = gapneedle::reverseComplement(query);
+    std::vector<std::pair<std::string, std::string>> records = {{"a", std::string((std::size_t{8} << 20) + 5000, 'A')},
+                                                                {"b", std::string(20000, 'A')}};
+    unsigned state = 99u;
+    for (auto& [name, seq] : records) {
+      for (auto& c : seq) {
+        state = state * 1103515245u + 12345u;
+        c = "ACGTacgt"[(state >> 16) & 7];
+      }
+    }
+    std::string edited = query;
+    edited[5] = 'G';
+    edited.erase(20, 1);
+    records[0].second.replace((std::size_t{8} << 20) - 20, edited.size(), edited);
+    records[0].second.replace(300, query.size(), queryRc);
+    edited = queryRc;
+    edited.insert(10, "T");
+    records[1].second.replace(1000, edited.size(), edited);
+    records[1].second.replace(5000, 25, query.substr(0, 25));
+    {
+      std::ofstream fa(fastaPath, std::ios::binary);
+      for (const auto& [name, seq] : records) {
+        fa << '>' << name << '\n';
+        for (std::size_t i = 0; i < seq.size(); i += 80) fa << seq.substr(i, 80) << '\n';
+      }
+    }
+    std::filesystem::remove(fastaPath + ".fai");
+
+    for (const auto& [q, k] : std::vector<std::pair<std::string, unsigned>>{{query, 2}, {query.substr(0, 20), 3}}) {
+      std::vector<std::tuple<gapneedle::SeqPos, bool, gapneedle::SeqPos, unsigned>> expect;
+      std::vector<gapneedle::SearchHit> expectHits;
+      for (const auto& [name, seq] : records) {
+        std::string upper = seq;
+        gapneedle::toUpperInPlace(upper.data(), upper.size());
+        expect.clear();
+        for (const bool rev : {false, true}) {
+          const gapneedle::EditMatcher matcher(rev ? gapneedle::reverseComplement(q) : q, k);
+          matcher.scan(upper.data(), upper.size(), 0, upper.size(), [&](std::size_t end, unsigned edits) {
+            const auto start = static_cast<gapneedle::SeqPos>(matcher.alignStart(upper.data(), end));
+            expect.emplace_back(static_cast<gapneedle::SeqPos>(end), rev, start, edits);
+          });
+        }
+        std::sort(expect.begin(), expect.end());
+        for (const auto& [end, rev, start, edits] : expect) expectHits.push_back({name, start, end, rev, edits});
+      }
+      gapneedle::SearchOptions options;
+      options.maxEdits = k;
+      options.threads = 2;
+      const auto hits = gapneedle::searchFasta(fastaPath, q, options);
+      assert(hits.size() == expectHits.size());
+      for (std::size_t i = 0; i < hits.size(); ++i) {
+        assert(hits[i].seqName == expectHits[i].seqName && hits[i].start == expectHits[i].start &&
+               hits[i].end == expectHits[i].end && hits[i].reverse == expectHits[i].reverse &&
+               hits[i].edits == expectHits[i].edits);
+      }
+      if (q == query) {
+        assert(hits.size() == 3);
+        assert(hits[0].seqName == "a" && hits[0].start == 300 && hits[0].reverse && hits[0].edits == 0);
+        assert(hits[1].start == static_cast<gapneedle::SeqPos>((std::size_t{8} << 20) - 20) && hits[1].edits == 2);
+        assert(hits[2].seqName == "b" && hits[2].start == 1000 && hits[2].end == 1041 && hits[2].edits == 1);
+        std::ostringstream tsv;
+        gapneedle::writeSearchHits(tsv, {hits[2]}, true);
+        assert(tsv.str() == "b\t1000\t1041\t-\t1\n");
+      }
+    }
+  }
+
+  {
+    // The automaton must match a per-strand greedy scan for any mix of motifs, overlaps included.
+    const std::vector<std::string> motifs = {"ttaggg", "TTAGG", "CCCTAAA", "AA", "ACGT", "TTAGG"};
+    const gapneedle::MotifScanner scanner(motifs);
+    assert((scanner.motifs() == std::vector<std::string>{"TTAGGG", "TTAGG", "CCCTAAA", "AA", "ACGT"}));
+    std::string seq;
+    unsigned state = 777u;
+    for (int i = 0; i < 20000; ++i) {
+      state = state * 1103515245u + 12345u;
+      const unsigned r = (state >> 16) % 10;
+      seq += r < 3 ? std::string("TTAGGG") : r < 5 ? std::string("CCCTAAA") : std::string(1, "ACGTN"[r % 5]);
+    }
+    const auto stats = scanner.scan(seq);
+    for (std::size_t m = 0; m < scanner.motifs().size(); ++m) {
+      gapneedle::MotifRunStats expect;
+      const std::string& fwd = scanner.motifs()[m];
+      for (const std::string& motif : {fwd, gapneedle::reverseComplement(fwd)}) {
+        gapneedle::SeqPos run = 0;
+        for (std::size_t pos = 0; pos + motif.size() <= seq.size();) {
+          if (seq.compare(pos, motif.size(), motif) == 0) {
+            ++expect.copies;
+            expect.longestRun = std::max(expect.longestRun, ++run);
+            pos += motif.size();
+          } else {
+            run = 0;
+            ++pos;
+          }
+        }
+        if (gapneedle::reverseComplement(fwd) == fwd) break;
+      }
+      assert(stats[m].copies == expect.copies && stats[m].longestRun == expect.longestRun);
+    }
+    assert(stats[0].longestRun > 1 && stats[2].copies > 0);
+    // A motif base other than ACGT never matches, like one in the text.
+    const gapneedle::MotifScanner withN({"TTNGG", "ttngg", "CCCTAA"});
+    assert((withN.motifs() == std::vector<std::string>{"TTNGG", "CCCTAA"}));
+    const auto nStats = withN.scan("TTNGGTTAGGG");
+    assert(nStats[0].copies == 0 && nStats[1].copies == 1);
+    bool threw = false;
+    try {
+      gapneedle::MotifScanner({""});
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+
+  {
+    const std::string fastaPath = "/tmp/gapneedle_telomere_test.fa";
+    std::string telo;
+    for (int i = 0; i < 15; ++i) telo += "ccctaa";
+    std::string tail;
+    for (int i = 0; i < 15; ++i) tail += "TTAGGG";
+    {
+      std::ofstream fa(fastaPath);
+      fa << ">t1\n" << telo << std::string(500, 'A') << tail << "\n";
+      fa << ">t2\n" << std::string(300, 'C') << telo.substr(6) << std::string(300, 'G') << "\n";
+    }
+    assert(gapneedle::checkTelomere(fastaPath, "t1", 200) == std::make_pair(true, true));
+    assert(gapneedle::checkTelomere(fastaPath, "t1", 80) == std::make_pair(false, false));
+    assert(gapneedle::checkTelomere(fastaPath, "t2", 1000000) == std::make_pair(false, false));
+    assert(gapneedle::checkTelomere(fastaPath, "t2", 1000000, "ccctaa", 14) == std::make_pair(true, true));
+    assert(gapneedle::checkTelomere(fastaPath, "t1", 200, "CCCNAA") == std::make_pair(false, false));
+
+    gapneedle::TelomereScanOptions scan;
+    scan.window = 200;
+    scan.binBases = 100;
+    scan.threads = 2;
+    const auto reports = gapneedle::scanTelomeres(fastaPath, scan);
+    assert(reports.size() == 2);
+    assert(reports[0].seqName == "t1" && reports[0].length == 680);
+    for (const auto* end : {&reports[0].left, &reports[0].right}) {
+      assert(end->windowBases == 200 && end->repeatCount == 15 && end->longestRun == 15 && end->hasTelomere);
+      assert(end->density.size() == 2 && end->density[0] == 0.9 && end->density[1] == 0.0);
+    }
+    assert(reports[1].seqName == "t2" && reports[1].left.repeatCount == 0 && !reports[1].right.hasTelomere);
+
+    // One motif nested inside another must not lower the covered fraction.
+    for (const auto& motifs : {std::vector<std::string>{"CCCTAAA"}, std::vector<std::string>{"CCTAA", "CCCTAAA"},
+                               std::vector<std::string>{"CCCTAAA", "CCTAA"}}) {
+      const std::string nestedPath = "/tmp/gapneedle_telomere_nested.fa";
+      {
+        std::ofstream fa(nestedPath);
+        fa << ">n\nGGGGCCCTAAAGGGG\n";
+      }
+      gapneedle::TelomereScanOptions nested;
+      nested.window = 15;
+      nested.binBases = 15;
+      nested.motifs = motifs;
+      const auto nestedReport = gapneedle::scanTelomeres(nestedPath, nested);
+      assert(nestedReport[0].left.density.size() == 1 && nestedReport[0].left.density[0] == 7.0 / 15.0);
+    }
+    std::ostringstream tsv;
+    gapneedle::writeTelomereTsv(tsv, reports);
+    assert(tsv.str().find("t1\t680\tright\t200\t15\t15\tyes\t0.9000,0.0000\tCCCTAA:15:15\n") != std::string::npos);
+    std::ostringstream json;
+    gapneedle::writeTelomereJson(json, reports);
+    assert(json.str().find("{\"name\":\"t2\",\"length\":684,\"left\":{\"window\":200,\"repeats\":0") != std::string::npos);
+    bool threw = false;
+    try {
+      gapneedle::checkTelomere(fastaPath, "missing");
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+
+  {
+    // The streaming scanner follows runs across lines, reports sequences in file order and can
+    // ignore soft-masked 'n'.
+    const std::string fastaPath = "/tmp/gapneedle_gap_scan_test.fa";
+    std::string expectBed;
+    {
+      std::ofstream fa(fastaPath);
+      for (int r = 0; r < 12; ++r) {
+        std::string seq(300 + 37 * r, 'A');
+        std::fill(seq.begin() + 10 + r, seq.begin() + 50 + 2 * r, 'N');  // long, crosses lines
+        std::fill(seq.begin() + 100, seq.begin() + 104, 'N');         // below minGap
+        std::fill(seq.begin() + 150, seq.begin() + 170, 'n');         // soft-masked
+        std::fill(seq.end() - 12, seq.end(), 'N');                    // runs to the end
+        fa << ">z" << 11 - r << "\n";
+        for (std::size_t i = 0; i < seq.size(); i += 33) fa << seq.substr(i, 33) << '\n';
+        const std::string name = "z" + std::to_string(11 - r);
+        expectBed += name + "\t" + std::to_string(10 + r) + "\t" + std::to_string(50 + 2 * r) + "\n";
+        expectBed += name + "\t150\t170\n";
+        expectBed += name + "\t" + std::to_string(seq.size() - 12) + "\t" + std::to_string(seq.size()) + "\n";
+      }
+    }
+    gapneedle::GapScanOptions opts;
+    opts.minGap = 10;
+    opts.threads = 4;
+    std::vector<std::string> order;
+    std::ostringstream bed;
+    gapneedle::scanGaps(fastaPath, opts, [&](const std::string& name, const std::vector<gapneedle::GapRecord>& gaps) {
+      order.push_back(name);
+      gapneedle::writeGapsBed(bed, gaps);
+    });
+    assert(order.size() == 12 && order.front() == "z11" && order.back() == "z0");
+    assert(bed.str() == expectBed);
+
+    opts.caseInsensitive = false;
+    const auto strict = gapneedle::scanGaps(fastaPath, opts);
+    assert(strict.size() == 24);
+    for (const auto& g : strict) assert(g.start != 150);
+
+    // The gap index answers any threshold or range like a fresh scan would.
+    std::filesystem::remove(gapneedle::gapIndexPathOf(fastaPath));
+    gapneedle::clearGapIndexPool();
+    const auto index = gapneedle::acquireGapIndex(fastaPath);
+    assert(!index->loadedFromSidecar());
+    assert(std::filesystem::exists(gapneedle::gapIndexPathOf(fastaPath)));
+    assert(gapneedle::acquireGapIndex(fastaPath) == index);
+    assert(index->names().size() == 12 && index->names().front() == "z11");
+    for (const gapneedle::SeqPos minGap : {1, 4, 5, 12, 13, 40, 41, 1000}) {
+      opts.minGap = minGap;
+      opts.caseInsensitive = true;
+      gapneedle::GapQuery q;
+      q.minGap = minGap;
+      const auto fromIndex = index->query(q);
+      const auto scanned = gapneedle::scanGaps(fastaPath, opts);
+      assert(fromIndex.size() == scanned.size());
+      for (std::size_t i = 0; i < scanned.size(); ++i) {
+        assert(fromIndex[i].seqName == scanned[i].seqName);
+        assert(fromIndex[i].start == scanned[i].start && fromIndex[i].end == scanned[i].end);
+      }
+    }
+    gapneedle::GapQuery ranged;
+    ranged.seqName = "z0";
+    ranged.start = 40;
+    ranged.end = 151;
+    ranged.minGap = 1;
+    const auto inRange = index->query(ranged);
+    assert(inRange.size() == 3);
+    assert(inRange[0].start == 21 && inRange[1].start == 100 && inRange[2].start == 150);
+    ranged.minGap = 5;
+    assert(index->query(ranged).size() == 2);
+    ranged.seqName = "missing";
+    assert(index->query(ranged).empty());
+
+    // A matching sidecar is trusted without reading bases: same size and mtime, gaps erased.
+    const auto mtime = std::filesystem::last_write_time(fastaPath);
+    std::string text;
+    {
+      std::ifstream in(fastaPath, std::ios::binary);
+      text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::string erased = text;
+    std::replace(erased.begin(), erased.end(), 'N', 'A');
+    {
+      std::ofstream out(fastaPath, std::ios::binary | std::ios::trunc);
+      out << erased;
+    }
+    std::filesystem::last_write_time(fastaPath, mtime);
+    gapneedle::clearGapIndexPool();
+    gapneedle::GapNeedleFacade facade;
+    gapneedle::GapQuery all;
+    all.minGap = 10;
+    assert(facade.queryGaps(fastaPath, all).size() == 36);
+    assert(gapneedle::GapIndex(fastaPath).loadedFromSidecar());
+
+    // Any change to the FASTA invalidates it.
+    {
+      std::ofstream out(fastaPath, std::ios::binary | std::ios::app);
+      out << ">extra\nNNNNNNNNNNNN\n";
+    }
+    const auto rebuilt = gapneedle::acquireGapIndex(fastaPath);
+    assert(!rebuilt->loadedFromSidecar());
+    const auto after = facade.queryGaps(fastaPath, all);
+    assert(after.size() == 12 + 1 && after.back().seqName == "extra");  // soft-masked runs + the new record
+    all.caseInsensitive = false;
+    assert(facade.queryGaps(fastaPath, all).size() == 1);
+    assert(std::filesystem::exists(gapneedle::gapIndexPathOf(fastaPath, false)));
+  }
+
+  {
+    // Name listing scans headers only, and short-circuits through a current .fai.
+    const std::string fastaPath = "/tmp/gapneedle_names_test.fa";
+    std::filesystem::remove(fastaPath + ".fai");
+    {
+      std::ofstream fa(fastaPath, std::ios::binary);
+      fa << ">a first\r\nACGT\r\n>\nAC\n> b\nAC>GT\n>a dup\nA\n>c";
+    }
+    assert((gapneedle::readFastaNames(fastaPath) == std::vector<std::string>{"a", "b", "c"}));
+    assert(!std::filesystem::exists(fastaPath + ".fai"));
+    {
+      std::ofstream fai(fastaPath + ".fai");
+      fai << "x\t4\t10\t4\t6\ny\t2\t20\t2\t3\n";
+    }
+    assert((gapneedle::readFastaNames(fastaPath) == std::vector<std::string>{"x", "y"}));
+    std::filesystem::last_write_time(fastaPath + ".fai", std::filesystem::last_write_time(fastaPath) - std::chrono::hours(1));
+    assert((gapneedle::readFastaNames(fastaPath) == std::vector<std::string>{"a", "b", "c"}));
+    std::filesystem::remove(fastaPath + ".fai");
+    bool threw = false;
+    try {
+      gapneedle::readFastaNames("/tmp/gapneedle_names_missing.fa");
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+
+  {
+    // Records without bases are listed and indexed the same way with or without a .fai.
+    const std::string fastaPath = "/tmp/gapneedle_empty_record_test.fa";
+    std::filesystem::remove(fastaPath + ".fai");
+    {
+      std::ofstream fa(fastaPath, std::ios::binary);
+      fa << ">e1\n>a\nACGT\n>e2\n";
+    }
+    const std::vector<std::string> expected{"e1", "a", "e2"};
+    assert(gapneedle::readFastaNames(fastaPath) == expected);
+    gapneedle::FastaIndexedReader reader(fastaPath);
+    {
+      std::ifstream fai(fastaPath + ".fai");
+      const std::string text((std::istreambuf_iterator<char>(fai)), std::istreambuf_iterator<char>());
+      assert(text == "e1\t0\t4\t0\t0\na\t4\t7\t4\t5\ne2\t0\t16\t0\t0\n");
+    }
+    assert(reader.listNames() == expected);
+    assert(gapneedle::readFastaNames(fastaPath) == expected);
+    assert(reader.length("e1") == 0 && reader.length("e2") == 0);
+    assert(reader.fetch("e1", 0, 10).empty());
+    assert(reader.fetch("a", 0, 4) == "ACGT");
+    assert(gapneedle::FastaIndexedReader(fastaPath).length("e2") == 0);  // reloaded from the .fai
+  }
+
+  {
+    // A .gnseq container answers every read exactly like the FASTA it was packed from.
+    const std::string fastaPath = "/tmp/gapneedle_gnseq_test.fa";
+    const std::string gnseqPath = "/tmp/gapneedle_gnseq_test.gnseq";
+    {
+      std::ofstream fa(fastaPath, std::ios::binary);
+      fa << ">g1 desc\n";
+      for (int i = 0; i < 3000; ++i) {
+        fa << ((i / 700) % 2 == 1 && i % 700 < 40 ? 'N' : "acgtACGTRY"[(i * 13) % 10]);
+        if (i % 70 == 69) fa << '\n';
+      }
+      fa << "\n>g2\nNNNNNNNNNNNNACGTnnnnnnnnnnnnnnnnnnnnT\n";
+    }
+    gapneedle::writeGnseq(fastaPath, gnseqPath);
+    assert(gapneedle::isGnseqFile(gnseqPath));
+    assert(!gapneedle::isGnseqFile(fastaPath));
+    assert(!std::filesystem::exists(gnseqPath + ".fai"));
+
+    const gapneedle::FastaIndexedReader fasta(fastaPath);
+    const gapneedle::FastaIndexedReader packed(gnseqPath);
+    assert(packed.listNames() == fasta.listNames());
+    assert(packed.length("g1") == 3000 && packed.length("g2") == 37);
+    for (const int start : {0, 1, 3, 699, 700, 1399, 2990}) {
+      for (const int len : {1, 5, 64, 1000}) {
+        assert(packed.fetch("g1", start, start + len) == fasta.fetch("g1", start, start + len));
+        assert(packed.fetch({"g1", start, start + len, true}) == fasta.fetch({"g1", start, start + len, true}));
+      }
+    }
+    std::string visited;
+    packed.visit("g2", 5, 30, [&visited](std::string_view piece) { visited.append(piece); });
+    assert(visited == fasta.fetch("g2", 5, 30));
+    const std::vector<gapneedle::FastaRegion> regions = {{"g2", 0, 37, false}, {"g1", 100, 200, true}, {"g1", 2990, 3100, false}};
+    assert(packed.fetchMany(regions) == fasta.fetchMany(regions));
+    for (const auto& name : fasta.listNames()) {
+      assert(packed.sequenceDigest(name) == fasta.sequenceDigest(name));
+    }
+    assert(packed.sequenceDigest("g1") != packed.sequenceDigest("g2"));
+
+    const auto fromFasta = gapneedle::readFasta(fastaPath);
+    assert(gapneedle::readFasta(gnseqPath) == fromFasta);
+    assert(gapneedle::readFastaPacked(gnseqPath).at("g1").decode() == fromFasta.at("g1"));
+    assert(gapneedle::readFastaNames(gnseqPath) == gapneedle::readFastaNames(fastaPath));
+
+    gapneedle::GapNeedleFacade facade;
+    for (const int minGap : {1, 12, 30}) {
+      assert(facade.scanGaps(gnseqPath, minGap) == facade.scanGaps(fastaPath, minGap));
+    }
+    assert(facade.scanGaps(gnseqPath, 10).size() == 4);
+
+    {
+      std::fstream corrupt(gnseqPath, std::ios::in | std::ios::out | std::ios::binary);
+      corrupt.seekp(16);
+      const char huge[8] = {'\xff', '\xff', '\xff', '\xff', '\xff', '\xff', '\xff', '\x7f'};
+      corrupt.write(huge, sizeof(huge));
+    }
+    bool threw = false;
+    try {
+      gapneedle::FastaIndexedReader broken(gnseqPath);
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+
+  {
+    const std::string fastaPath = "/tmp/gapneedle_stream_test.fa";
+    {
+      std::ofstream fa(fastaPath);
+      fa << "junk\n>r1 first\nacgt\r\nACGT\r\n>\nTTTT\n>r2\n>r3\nGGGGCCCC";
+    }
+    gapneedle::FastaStreamReader whole(fastaPath, 4096);
+    std::string name;
+    std::string seq;
+    assert(whole.next(name, seq) && name == "r1" && seq == "ACGTACGT");
+    assert(whole.next(name, seq) && name == "r2" && seq.empty());
+    assert(whole.next(name, seq) && name == "r3" && seq == "GGGGCCCC");
+    assert(!whole.next(name, seq));
+
+    gapneedle::FastaStreamReader chunked(fastaPath, 4096);
+    std::vector<std::string> chunks;
+    assert(chunked.nextRecord(name) && name == "r1");
+    while (chunked.readChunk(seq, 3)) chunks.push_back(seq);
+    assert((chunks == std::vector<std::string>{"ACG", "TAC", "GT"}));
+    assert(chunked.nextRecord(name) && name == "r2");
+    assert(!chunked.readChunk(seq, 3));
+    assert(chunked.nextRecord(name) && name == "r3");
+    assert(!chunked.nextRecord(name));
+
+    std::filesystem::remove(fastaPath + ".fai");
+    const auto selected = gapneedle::readFastaSelected(fastaPath, {"r3", "r1", "missing", "r3"});
+    assert(selected.size() == 2);
+    assert(selected.at("r3") == "GGGGCCCC");
+    assert(selected.at("r1") == "ACGTACGT");
+    assert(std::filesystem::exists(fastaPath + ".fai"));
+  }
+
+  {
+    // FastaWriter wraps pieces across line boundaries and its .fai matches a rebuilt one.
+    const std::string fastaPath = "/tmp/gapneedle_writer_test.fa";
+    auto slurp = [](const std::string& path) {
+      std::ifstream in(path, std::ios::binary);
+      return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    };
+    gapneedle::FastaWriterOptions opts;
+    opts.lineWidth = 4;
+    opts.writeFai = true;
+    {
+      gapneedle::FastaWriter out(fastaPath, opts);
+      out.beginRecord("w1 desc");
+      out.append("ACG");
+      out.append("TACGTA");
+      out.append("");
+      out.append("CGT");
+      out.writeRecord("w2", "");
+      out.writeRecord("w3", "GG");
+      out.writeRecord("w4", "TTTT");
+      out.commit();
+    }
+    assert(slurp(fastaPath) == ">w1 desc\nACGT\nACGT\nACGT\n>w2\n>w3\nGG\n>w4\nTTTT\n");
+    const std::string writtenFai = slurp(fastaPath + ".fai");
+    assert(gapneedle::FastaIndexedReader(fastaPath).length("w2") == 0);  // the written .fai is accepted
+    std::filesystem::remove(fastaPath + ".fai");
+    gapneedle::FastaIndexedReader reader(fastaPath);
+    assert(slurp(fastaPath + ".fai") == writtenFai);
+    assert(reader.fetch("w1", 2, 10) == "GTACGTAC");
+    assert(reader.length("w3") == 2);
+
+    // Without commit the destination keeps its previous content.
+    {
+      gapneedle::FastaWriter out(fastaPath);
+      out.writeRecord("other", "AAAA");
+    }
+    assert(slurp(fastaPath).rfind(">w1 desc\n", 0) == 0);
+    for (const auto& entry : std::filesystem::directory_iterator("/tmp")) {
+      const std::string file = entry.path().filename().string();
+      assert(file == "gapneedle_writer_test.fa" || file == "gapneedle_writer_test.fa.fai" ||
+             file.rfind("gapneedle_writer_test.fa", 0) != 0);
+    }
+
+    // lineWidth 0 writes each record on a single line.
+    gapneedle::FastaWriterOptions unwrapped;
+    unwrapped.lineWidth = 0;
+    unwrapped.writeFai = true;
+    {
+      gapneedle::FastaWriter out(fastaPath, unwrapped);
+      out.beginRecord("u1");
+      out.append("ACGTA");
+      out.append("CGTAC");
+      out.writeRecord("u2", "");
+      out.writeRecord("u3", "GGT");
+      out.commit();
+    }
+    assert(slurp(fastaPath) == ">u1\nACGTACGTAC\n>u2\n>u3\nGGT\n");
+    const std::string unwrappedFai = slurp(fastaPath + ".fai");
+    assert(unwrappedFai == "u1\t10\t4\t10\t11\nu2\t0\t19\t0\t0\nu3\t3\t23\t3\t4\n");
+    {
+      gapneedle::FastaIndexedReader fromWritten(fastaPath);
+      assert(fromWritten.listNames() == (std::vector<std::string>{"u1", "u2", "u3"}));
+      assert(fromWritten.fetch("u1", 3, 10) == "TACGTAC");
+      assert(fromWritten.fetch("u3", 0, 3) == "GGT");
+    }
+    std::filesystem::remove(fastaPath + ".fai");
+    const gapneedle::FastaIndexedReader rebuilt(fastaPath);
+    assert(slurp(fastaPath + ".fai") == unwrappedFai);
+    std::filesystem::remove(fastaPath + ".fai");
+
+    gapneedle::FastaMap records{{"z", "ACGT"}, {"a", "TTTT"}, {"m", std::string(100, 'C')}};
+    gapneedle::writeFasta(fastaPath, records);
+    const std::string text = slurp(fastaPath);
+    assert(text.find(">a\n") < text.find(">m\n") && text.find(">m\n") < text.find(">z\n"));
+    assert(text.find(std::string(80, 'C') + "\n" + std::string(20, 'C') + "\n") != std::string::npos);
+    assert(!std::filesystem::exists(fastaPath + ".fai"));
+    assert(gapneedle::readFasta(fastaPath) == records);
+  }
+
+  {
+    const std::string fastaPath = "/tmp/gapneedle_stale_fai_test.fa";
+    {
+      std::ofstream fa(fastaPath);
+      fa << ">a\nAAAACCCC\nGG\n";
+    }
+    std::filesystem::remove(fastaPath + ".fai");
+    assert(gapneedle::FastaIndexedReader(fastaPath).fetch("a", 6, 10) == "CCGG");
+
+    // Edit in place; the old index must not be trusted even though it still parses.
+    {
+      std::ofstream fa(fastaPath);
+      fa << ">b\nTT\n>a\nGGGGTTTT\nAA\n";
+    }
+    std::filesystem::last_write_time(fastaPath,
+                                     std::filesystem::last_write_time(fastaPath + ".fai") + std::chrono::seconds(2));
+    assert(gapneedle::FastaIndexedReader(fastaPath).fetch("a", 6, 10) == "TTAA");
+
+    // Concurrent first opens: one builder, everyone else reuses the published index.
+    std::filesystem::remove(fastaPath + ".fai");
+    std::vector<std::thread> openers;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < 8; ++t) {
+      openers.emplace_back([&fastaPath, &failures]() {
+        try {
+          if (gapneedle::FastaIndexedReader(fastaPath).length("b") != 2) ++failures;
+        } catch (...) {
+          ++failures;
+        }
+      });
+    }
+    for (auto& th : openers) th.join();
+    assert(failures == 0);
+    assert(!std::filesystem::exists(fastaPath + ".fai.lock"));
+
+    // A lock file left behind by a crashed builder is not held by anyone and must not stall.
+    std::filesystem::remove(fastaPath + ".fai");
+    std::ofstream(fastaPath + ".fai.lock").close();
+    const auto t0 = std::chrono::steady_clock::now();
+    assert(gapneedle::FastaIndexedReader(fastaPath).length("a") == 10);
+    assert(std::chrono::steady_clock::now() - t0 < std::chrono::seconds(5));
+    assert(!std::filesystem::exists(fastaPath + ".fai.lock"));
+  }
+
+  {
+    // Large enough that the .fai builder splits the file across several threads.
+    const std::string fastaPath = "/tmp/gapneedle_parallel_fai_test.fa";
+    const int records = 400;
+    {
+      std::ofstream fa(fastaPath, std::ios::binary);
+      const std::string line(60, 'A');
+      for (int r = 0; r < records; ++r) {
+        fa << ">chr" << r << " len=" << (r % 7) * 61 + 30000 << "\n";
+        const int len = (r % 7) * 61 + 30000;
+        for (int i = 0; i + 60 <= len; i += 60) fa << line << "\n";
+        fa << std::string(static_cast<std::size_t>(len % 60), 'C') << (len % 60 ? "\n" : "");
+      }
+    }
+    std::filesystem::remove(fastaPath + ".fai");
+    const auto names = gapneedle::readFastaNamesIndexed(fastaPath);
+    assert(static_cast<int>(names.size()) == records);
+    gapneedle::FastaIndexedReader reader(fastaPath);
+    for (int r = 0; r < records; ++r) {
+      assert(names[static_cast<std::size_t>(r)] == "chr" + std::to_string(r));
+      const int len = (r % 7) * 61 + 30000;
+      assert(reader.length(names[static_cast<std::size_t>(r)]) == len);
+    }
+    assert(reader.fetch("chr398", 30366 - 7, 30366) == "ACCCCCC");
+    for (const auto& entry : std::filesystem::directory_iterator("/tmp")) {
+      assert(entry.path().string().find("gapneedle_parallel_fai_test.fa.fai.tmp") == std::string::npos);
+    }
+  }
+
+#if GAPNEEDLE_HAS_ZLIB
+  {
+    const std::string gzPath = "/tmp/gapneedle_bgzf_test.fa.gz";
+    std::string plain = ">c1\n";
+    for (int i = 0; i < 50; ++i) plain += "ACGTACGTAC\n";
+    plain += ">c2\nggggccccaa\ntt\n";
+    writeBgzf(gzPath, plain, 37);
+    std::filesystem::remove(gzPath + ".fai");
+    std::filesystem::remove(gzPath + ".gzi");
+
+    assert((gapneedle::readFastaNamesIndexed(gzPath) == std::vector<std::string>{"c1", "c2"}));
+    assert(std::filesystem::exists(gzPath + ".gzi"));
+    gapneedle::FastaIndexedReader reader(gzPath);
+    assert(reader.length("c1") == 500);
+    assert(reader.fetch("c1", 95, 107) == "CGTACACGTACG");
+    assert(reader.fetch("c2", 6, 12) == "CCAATT");
+    assert(gapneedle::readFastaSliceIndexed(gzPath, "c1", 498, 500) == "AC");
+
+    // Concurrent first opens publish one complete .gzi and leave no temporaries or locks behind.
+    std::filesystem::remove(gzPath + ".gzi");
+    std::vector<std::thread> openers;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < 6; ++t) {
+      openers.emplace_back([&gzPath, &failures]() {
+        try {
+          if (gapneedle::FastaIndexedReader(gzPath).fetch("c2", 6, 12) != "CCAATT") ++failures;
+        } catch (...) {
+          ++failures;
+        }
+      });
+    }
+    for (auto& th : openers) th.join();
+    assert(failures == 0);
+    assert(gapneedle::FastaIndexedReader(gzPath).fetch("c1", 95, 107) == "CGTACACGTACG");
+    for (const auto& entry : std::filesystem::directory_iterator("/tmp")) {
+      const std::string file = entry.path().filename().string();
+      assert(file.rfind("gapneedle_bgzf_test.fa.gz.gzi.", 0) != 0);
+    }
+
+    // Stitching reads bgzipped sources through the same stream reader as readFasta.
+    const auto packed = gapneedle::readFastaPacked(gzPath);
+    assert(packed.size() == 2 && packed.at("c1").size() == 500);
+    gapneedle::StitchRequest req;
+    req.targetFasta = gzPath;
+    req.queryFasta = gzPath;
+    req.outputFastaPath = "/tmp/gapneedle_bgzf_stitch.fa";
+    req.segments.push_back(gapneedle::Segment{"t", "c1", 0, 10, false});
+    req.segments.push_back(gapneedle::Segment{"q", "c2", 6, 12, false});
+    const auto stitched = gapneedle::GapNeedleFacade().stitch(req);
+    assert(stitched.mergedLength == 16);
+    std::string merged = gapneedle::readFasta(req.outputFastaPath).at("stitched");
+    gapneedle::toUpperInPlace(merged.data(), merged.size());
+    assert(merged == "ACGTACGTACCCAATT");
+  }
+#endif
+
   {
     std::ofstream paf("/tmp/gapneedle_test.paf");
     paf << "q1\t100\t10\t40\t+\tt1\t120\t20\t50\t25\t30\t60\tcg:Z:30M\n";
@@ -29,6 +1260,129 @@ int main() {
     assert(m.tPos.value() == 25);
   }
 
+  {
+    // Coordinates past 2^31 survive PAF parsing and CIGAR mapping.
+    std::ofstream paf("/tmp/gapneedle_test_64bit.paf");
+    paf << "q1\t3000000000\t2500000000\t2500000100\t-\tt1\t4000000000\t3500000000\t3500000100"
+           "\t100\t100\t60\tcg:Z:100M\n";
+    paf.close();
+
+    auto recs = gapneedle::parsePaf("/tmp/gapneedle_test_64bit.paf", "t1", "q1");
+    assert(recs.size() == 1);
+    assert(recs[0].qLen == 3000000000LL);
+    assert(recs[0].tStart == 3500000000LL);
+    assert(recs[0].tEnd == 3500000100LL);
+    auto m = gapneedle::mapQueryToTargetDetail(recs[0], 2500000010LL);
+    assert(m.reason == "ok");
+    assert(m.tPos.has_value());
+    assert(m.tPos.value() == 3500000089LL);
+  }
+
+  {
+    // Only the requested pair is kept; optional tags, CRLF endings and short lines are handled.
+    const std::string pafPath = "/tmp/gapneedle_test_fields.paf";
+    {
+      std::ofstream paf(pafPath, std::ios::binary);
+      paf << "q1\t100\t0\t10\t+\tt2\t120\t0\t10\t10\t10\t60\n"
+          << "q1\t100\t5\t15\t-\tt1\t120\t7\t17\t9\t10\t3\ttp:A:P\t\tcg:Z:10M\r\n"
+          << "q1\tshort\tline\n"
+          << "\n"
+          << "q10\t100\t0\t10\t+\tt1\t120\t0\t10\t10\t10\t60\n"
+          << "q1\t100\t20\t30\t+\tt1\t120\t40\t50\t10\t10\t0\t";
+    }
+    auto recs = gapneedle::parsePaf(pafPath, "t1", "q1");
+    assert(recs.size() == 2);
+    assert(recs[0].qName == "q1" && recs[0].tName == "t1" && recs[0].strand == '-');
+    assert(recs[0].qStart == 5 && recs[0].tEnd == 17 && recs[0].matches == 9 && recs[0].mapq == 3);
+    assert((recs[0].extras == std::vector<std::string>{"tp:A:P", "", "cg:Z:10M"}));
+    assert(recs[1].tStart == 40 && recs[1].mapq == 0 && recs[1].extras.empty());
+
+    {
+      std::ofstream paf(pafPath, std::ios::app);
+      paf << "\nq1\t100\tx\t30\t+\tt1\t120\t40\t50\t10\t10\t0\n";
+    }
+    bool threw = false;
+    try {
+      gapneedle::parsePaf(pafPath, "t1", "q1");
+    } catch (const std::runtime_error& e) {
+      threw = std::string(e.what()).find("line 7") != std::string::npos;
+    }
+    assert(threw);
+    assert(gapneedle::parsePaf(pafPath, "t1", "q2").empty());  // other pairs never parse numbers
+  }
+
+  {
+    // A sparse FASTA with a contig longer than INT_MAX: only the first and last lines hold data.
+    const std::string path = "/tmp/gapneedle_test_large.fa";
+    const gapneedle::SeqPos lineBases = 1000;
+    const gapneedle::SeqPos lines = 2200000;
+    const gapneedle::SeqPos len = lineBases * lines;
+    const std::string header = ">big\n";
+    const std::string firstLine = std::string(lineBases - 4, 'A') + "CCGG\n";
+    const std::string lastLine = "TTAA" + std::string(lineBases - 8, 'C') + "ACGT\n";
+    {
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      out << header << firstLine;
+    }
+    const auto fileSize = static_cast<std::uintmax_t>(header.size()) +
+                          static_cast<std::uintmax_t>(lines * (lineBases + 1));
+    std::filesystem::resize_file(path, fileSize);
+    {
+      std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+      out.seekp(static_cast<std::streamoff>(fileSize - lastLine.size()));
+      out << lastLine;
+    }
+    {
+      std::ofstream fai(path + ".fai", std::ios::trunc);
+      fai << "big\t" << len << "\t" << header.size() << "\t" << lineBases << "\t" << lineBases + 1 << "\n";
+    }
+
+    gapneedle::FastaIndexedReader reader(path);
+    assert(len > 2147483647LL);
+    assert(reader.length("big") == len);
+    assert(reader.fetch("big", 996, 1000) == "CCGG");
+    assert(reader.fetch("big", len - 4, len) == "ACGT");
+    assert(reader.fetch("big", len - lineBases, len - lineBases + 4) == "TTAA");
+    assert(reader.fetch(gapneedle::FastaRegion{"big", 0, 4, true}) == "ACGT");
+    assert(reader.fetch(gapneedle::FastaRegion{"big", len - 1000, len - 996, true}) == "CCGG");
+    assert(gapneedle::readFastaSliceIndexed(path, "big", len - 2, len + 10) == "GT");
+    // Only the end windows are read, so this stays cheap on a contig longer than INT_MAX.
+    assert(gapneedle::checkTelomere(path, "big", 1000, "CCGG", 1) == std::make_pair(true, false));
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".fai");
+  }
+
+  {
+    // The .fai builder on an unwrapped contig longer than INT_MAX: one line, so the line geometry
+    // itself exceeds 32 bits. Sparse zeros count as bases, like any other non-space byte.
+    const std::string path = "/tmp/gapneedle_test_large_line.fa";
+    const gapneedle::SeqPos len = (gapneedle::SeqPos{1} << 31) + 16;
+    const std::string header = ">line\n";
+    {
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      out << header << "GATTACA";
+    }
+    std::filesystem::resize_file(path, header.size() + static_cast<std::uintmax_t>(len) + 1);
+    {
+      std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+      out.seekp(static_cast<std::streamoff>(header.size() + static_cast<std::uintmax_t>(len) - 4));
+      out << "ACGT\n";
+    }
+    std::filesystem::remove(path + ".fai");
+
+    gapneedle::FastaIndexedReader reader(path);
+    assert(reader.length("line") == len);
+    assert(reader.fetch("line", 0, 7) == "GATTACA");
+    assert(reader.fetch("line", len - 4, len) == "ACGT");
+    std::ifstream fai(path + ".fai");
+    std::string faiLine;
+    std::getline(fai, faiLine);
+    assert(faiLine == "line\t" + std::to_string(len) + "\t" + std::to_string(header.size()) + "\t" + std::to_string(len) +
+                          "\t" + std::to_string(len + 1));
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".fai");
+  }
+
   {
     std::ofstream paf("/tmp/gapneedle_guided_test.paf");
     paf << "q1\t100\t0\t20\t+\tt1\t200\t0\t20\t20\t20\t60\tcg:Z:20M\n";